@@ -0,0 +1,99 @@
+#include "array_reader.hpp"
+#include "mappedfile.hpp"
+#include "parser_impl.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+using SimpleJsonParser::ArrayElementReader;
+using SimpleJsonParser::MemoryMappedFile;
+using SimpleJsonParser::NormalParser;
+using SimpleJsonParser::ReadAheadArrayReader;
+using SimpleJsonParser::Value;
+
+static void write_corpus(const char* path, size_t target_bytes) {
+    FILE* fp = std::fopen(path, "w");
+    if(fp == nullptr) {
+        std::perror(path);
+        std::exit(1);
+    }
+
+    size_t written = std::fprintf(fp, "[\n");
+    for(size_t i = 0; written < target_bytes; ++i) {
+        written += std::fprintf(fp,
+            "%s{\"id\": %zu, \"name\": \"element %zu\", \"score\": %zu.25, \"tags\": [\"alpha\", \"beta\", \"gamma\"], \"valid\": true}",
+            i == 0 ? "" : ",\n", i, i, i % 1000);
+    }
+    std::fprintf(fp, "\n]\n");
+    std::fclose(fp);
+}
+
+static double peak_rss_mib() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+template<typename Reader>
+static size_t consume(Reader& reader) {
+    size_t count = 0;
+    for(Value& value : reader) {
+        count += value.is_object();
+    }
+    return count;
+}
+
+/* Each mode runs in its own process so that peak RSS is measured independently. */
+static void run_mode(const char* mode, const char* path) {
+    MemoryMappedFile file;
+    if(!file.open_file(path)) {
+        std::perror(path);
+        std::exit(1);
+    }
+
+    size_t count = 0;
+    auto start = std::chrono::steady_clock::now();
+    if(std::strcmp(mode, "full") == 0) {
+        NormalParser parser;
+        Value doc = parser.parse(file.begin(), file.end()).m_value;
+        count = doc.size_array();
+    }
+    else if(std::strcmp(mode, "lazy") == 0) {
+        ArrayElementReader reader(file);
+        count = consume(reader);
+    }
+    else {
+        ReadAheadArrayReader reader(file, 64);
+        count = consume(reader);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%-10s %zu elements, %.3f s, %.1f MB/s, peak RSS %.1f MiB\n",
+        mode, count, seconds, file.size() / seconds / 1e6, peak_rss_mib());
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+    const char* path = argc > 2 ? argv[2] : "/tmp/simple_json_parser_bench_array.json";
+
+    write_corpus(path, megabytes * 1000 * 1000);
+    std::printf("corpus: %s (%zu MB)\n", path, megabytes);
+
+    for(const char* mode : {"full", "lazy", "readahead"}) {
+        std::fflush(stdout);
+        pid_t pid = fork();
+        if(pid == 0) {
+            run_mode(mode, path);
+            std::fflush(stdout);
+            std::_Exit(0);
+        }
+        waitpid(pid, nullptr, 0);
+    }
+
+    std::remove(path);
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "document.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using SimpleJsonParser::Value;
+using SimpleJsonParser::ValueType;
+
+static size_t resident_bytes() {
+    size_t pages = 0, resident = 0;
+    FILE* fp = std::fopen("/proc/self/statm", "r");
+    if(fp == nullptr)
+        return 0;
+    if(std::fscanf(fp, "%zu %zu", &pages, &resident) != 2)
+        resident = 0;
+    std::fclose(fp);
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+/* A config document: many services, each with a handful of settings */
+static Value make_config(size_t services) {
+    Value config{ValueType::Object};
+    Value list{ValueType::Object};
+    for(size_t i = 0; i < services; ++i) {
+        Value service{ValueType::Object};
+        service["host"] = Value{"service-" + std::to_string(i) + ".internal.example"};
+        service["port"] = Value{static_cast<int64_t>(8000 + i % 1000)};
+        service["timeout"] = Value{2.5};
+        Value replicas{ValueType::Array};
+        for(int j = 0; j < 4; ++j) {
+            replicas.push_back(Value{"replica-" + std::to_string(j)});
+        }
+        service["replicas"] = std::move(replicas);
+        list["service" + std::to_string(i)] = std::move(service);
+    }
+    config["services"] = std::move(list);
+    config["version"] = Value{static_cast<int64_t>(1)};
+    return config;
+}
+
+/* Every handler takes its own copy and tweaks two fields */
+template<typename Clone>
+static void run(const char* label, const Value& config, size_t handlers, Clone clone) {
+    std::vector<Value> copies;
+    copies.reserve(handlers);
+    size_t rss_before = resident_bytes();
+
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < handlers; ++i) {
+        Value copy = clone(config);
+        copy["version"] = Value{static_cast<int64_t>(i)};
+        copy["services"]["service" + std::to_string(i)]["timeout"] = Value{5.0};
+        copies.push_back(std::move(copy));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%-10s %zu copies, %.3f ms per clone-and-modify, +%.1f MiB RSS\n",
+        label, handlers, seconds * 1e3 / handlers, (resident_bytes() - rss_before) / 1048576.0);
+}
+
+int main() {
+    const size_t services = 20000;
+    const size_t handlers = 50;
+    Value config = make_config(services);
+
+    /* Copy-on-write first, so it cannot reuse memory freed by the deep copies */
+    run("cow clone", config, handlers, [](const Value& v) { return v.clone(); });
+    run("deep clone", config, handlers, [](const Value& v) { return v.deep_clone(); });
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "document.hpp"
+#include <chrono>
+#include <cstdio>
+#include <unordered_set>
+#include <vector>
+
+using SimpleJsonParser::Value;
+using SimpleJsonParser::ValueType;
+
+/* Documents share their layout and only differ in their last leaf, the worst case for deep comparison. */
+static Value make_document(int64_t id) {
+    Value doc{ValueType::Object};
+    doc["name"] = Value{"document"};
+    Value tags{ValueType::Array};
+    for(int i = 0; i < 16; ++i) {
+        tags.push_back(Value{"tag-" + std::to_string(i)});
+    }
+    tags.push_back(Value{id});
+    doc["tags"] = std::move(tags);
+    Value nested{ValueType::Object};
+    for(int i = 0; i < 8; ++i) {
+        nested["field" + std::to_string(i)] = Value{static_cast<double>(i)};
+    }
+    doc["nested"] = std::move(nested);
+    return doc;
+}
+
+static std::vector<Value> make_corpus(size_t count, size_t distinct) {
+    std::vector<Value> docs;
+    docs.reserve(count);
+    for(size_t i = 0; i < count; ++i) {
+        docs.push_back(make_document(static_cast<int64_t>(i % distinct)));
+    }
+    return docs;
+}
+
+template<typename Equal>
+static size_t pairwise_dedup(const std::vector<Value>& docs, Equal equal) {
+    std::vector<const Value*> unique;
+    for(const Value& doc : docs) {
+        bool found = false;
+        for(const Value* other : unique) {
+            if(equal(doc, *other)) {
+                found = true;
+                break;
+            }
+        }
+        if(!found)
+            unique.push_back(&doc);
+    }
+    return unique.size();
+}
+
+template<typename F>
+static double measure(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+int main() {
+    const size_t pairwise_count = 4000;
+    const size_t set_count = 400000;
+    const size_t distinct = 1000;
+
+    {
+        std::vector<Value> docs = make_corpus(pairwise_count, distinct);
+        size_t unique = 0;
+        double t = measure([&] {
+            unique = pairwise_dedup(docs, [](const Value& a, const Value& b) { return a == b; });
+        });
+        std::printf("pairwise operator==  : %zu docs, %zu unique, %.3f s, %.0f docs/s\n", docs.size(), unique, t, docs.size() / t);
+    }
+
+    {
+        std::vector<Value> docs = make_corpus(pairwise_count, distinct);
+        size_t unique = 0;
+        double t = measure([&] {
+            unique = pairwise_dedup(docs, [](const Value& a, const Value& b) { return a.equals(b); });
+        });
+        std::printf("pairwise equals      : %zu docs, %zu unique, %.3f s, %.0f docs/s\n", docs.size(), unique, t, docs.size() / t);
+    }
+
+    {
+        std::vector<Value> docs = make_corpus(set_count, distinct);
+        std::unordered_set<Value> set;
+        double t = measure([&] {
+            for(Value& doc : docs) {
+                set.insert(std::move(doc));
+            }
+        });
+        std::printf("unordered_set<Value> : %zu docs, %zu unique, %.3f s, %.0f docs/s\n", docs.size(), set.size(), t, docs.size() / t);
+    }
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "incremental.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using SimpleJsonParser::IncrementalDocument;
+using SimpleJsonParser::NormalParser;
+
+static std::string make_corpus(size_t target_bytes) {
+    std::string json = "{\"items\": [";
+    for(size_t i = 0; json.size() < target_bytes; ++i) {
+        if(i != 0)
+            json += ",";
+        json += "{\"id\": " + std::to_string(i) + ", \"name\": \"item " + std::to_string(i) +
+            "\", \"price\": " + std::to_string(i % 1000) + ".75, \"tags\": [\"a\", \"b\", \"c\"], \"nested\": {\"x\": 1, \"y\": [2, 3]}}";
+    }
+    json += "], \"count\": 0}";
+    return json;
+}
+
+/* Median latency of edits that each replace one digit of an "x" member */
+static void run_edits(const char* label, IncrementalDocument& doc, int edits, bool reparse_all) {
+    std::mt19937 rng(1);
+    std::vector<double> latencies;
+    size_t local = 0;
+    for(int i = 0; i < edits; ++i) {
+        size_t offset = doc.text().find("\"x\": ", rng() % doc.text().size());
+        if(offset == std::string::npos)
+            offset = doc.text().find("\"x\": ");
+        offset += 5;
+
+        auto start = std::chrono::steady_clock::now();
+        if(reparse_all) {
+            std::string text = doc.text();
+            text.replace(offset, 1, std::to_string(i % 10));
+            NormalParser parser;
+            if(parser.parse(text).m_error_info.is_error()) {
+                std::printf("%s: parse error\n", label);
+                return;
+            }
+        }
+        else if(doc.apply_edit(offset, 1, std::to_string(i % 10))) {
+            ++local;
+        }
+        latencies.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("%-28s median %.3f ms, max %.3f ms", label, latencies[latencies.size() / 2] * 1e3, latencies.back() * 1e3);
+    if(!reparse_all)
+        std::printf(", %zu/%d local", local, edits);
+    std::printf("\n");
+}
+
+int main() {
+    std::string json = make_corpus(10 * 1000 * 1000);
+
+    auto start = std::chrono::steady_clock::now();
+    IncrementalDocument doc(json);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("initial parse with spans      %.3f s, %zu spans\n", seconds, doc.spans().size());
+
+    run_edits("full reparse per edit", doc, 10, true);
+    run_edits("incremental edit", doc, 200, false);
+
+    /* Inserting a member grows the document and changes the span count */
+    start = std::chrono::steady_clock::now();
+    size_t offset = doc.text().find("\"y\": ", json.size() / 2);
+    bool local = doc.apply_edit(offset, 0, "\"z\": [4, 5, {\"w\": null}], ");
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-28s %.3f ms, %s\n", "insert nested member", seconds * 1e3, local ? "local" : "full");
+    return 0;
+}
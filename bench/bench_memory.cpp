@@ -0,0 +1,69 @@
+#include "document.hpp"
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+using SimpleJsonParser::MemoryUsage;
+using SimpleJsonParser::Value;
+using SimpleJsonParser::ValueType;
+
+static size_t resident_bytes() {
+    size_t pages = 0, resident = 0;
+    FILE* fp = std::fopen("/proc/self/statm", "r");
+    if(fp == nullptr)
+        return 0;
+    if(std::fscanf(fp, "%zu %zu", &pages, &resident) != 2)
+        resident = 0;
+    std::fclose(fp);
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+static void release_free_memory() {
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+}
+
+/* Arrays grow element by element, the same way NormalParser::parse_array builds them. */
+static Value make_cached_document(size_t records) {
+    Value doc{ValueType::Array};
+    for(size_t i = 0; i < records; ++i) {
+        Value record{ValueType::Object};
+        record["id"] = Value{static_cast<int64_t>(i)};
+        record["label"] = Value{"record number " + std::to_string(i) + " of the cached document"};
+        Value samples{ValueType::Array};
+        for(int j = 0; j < 17; ++j) {
+            samples.push_back(Value{j * 0.5});
+        }
+        record["samples"] = std::move(samples);
+        doc.push_back(std::move(record));
+    }
+    return doc;
+}
+
+static void print_usage(const char* label, const MemoryUsage& usage) {
+    std::printf("%-8s nodes=%zu strings=%zu arrays=%zu objects=%zu\n", label, usage.num_nodes, usage.num_strings, usage.num_arrays, usage.num_objects);
+    std::printf("%-8s node=%.1f MiB string=%.1f MiB container=%.1f MiB slack=%.1f MiB total=%.1f MiB rss=%.1f MiB\n", label,
+        usage.node_bytes / 1048576.0, usage.string_bytes / 1048576.0, usage.container_bytes / 1048576.0,
+        usage.slack_bytes / 1048576.0, usage.total_bytes() / 1048576.0, resident_bytes() / 1048576.0);
+}
+
+int main() {
+    const size_t records = 200000;
+
+    Value doc = make_cached_document(records);
+    release_free_memory();
+    print_usage("before", doc.memory_summary());
+
+    auto start = std::chrono::steady_clock::now();
+    doc.compact();
+    auto stop = std::chrono::steady_clock::now();
+    release_free_memory();
+    print_usage("after", doc.memory_summary());
+
+    std::printf("compact: %.3f s\n", std::chrono::duration<double>(stop - start).count());
+    return 0;
+}
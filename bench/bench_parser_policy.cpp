@@ -0,0 +1,66 @@
+#include "parser_impl.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using SimpleJsonParser::BasicParser;
+using SimpleJsonParser::NormalParser;
+using SimpleJsonParser::ParserBase;
+using SimpleJsonParser::ParserSettings;
+using SimpleJsonParser::StaticPolicy;
+using SimpleJsonParser::make_parser;
+
+static std::string make_corpus(size_t target_bytes) {
+    std::string json = "[";
+    for(size_t i = 0; json.size() < target_bytes; ++i) {
+        if(i != 0)
+            json += ",";
+        json += "{\"id\": " + std::to_string(i) + ", \"name\": \"item " + std::to_string(i) +
+            "\", \"price\": " + std::to_string(i % 1000) + ".75, \"tags\": [\"a\", \"b\", \"c\"], \"nested\": {\"x\": 1, \"y\": [2, 3]}}";
+    }
+    json += "]";
+    return json;
+}
+
+static void run(const char* label, ParserBase& parser, const std::string& json, int rounds) {
+    double best = 1e30;
+    for(int i = 0; i < rounds; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        bool error = parser.parse(json).m_error_info.is_error();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if(error) {
+            std::printf("%s: parse error\n", label);
+            return;
+        }
+        best = seconds < best ? seconds : best;
+    }
+    std::printf("%-34s %.3f s, %.1f MB/s\n", label, best, json.size() / best / 1e6);
+}
+
+int main() {
+    const int rounds = 5;
+    std::string json = make_corpus(32 * 1000 * 1000);
+
+    ParserSettings limited;
+    limited.max_string_length = 1 << 20;
+    limited.max_array_length = 1 << 24;
+    limited.max_num_members = 1 << 10;
+
+    ParserSettings unlimited;
+    unlimited.max_depth_object = std::numeric_limits<unsigned>::max();
+
+    NormalParser runtime_limited(limited);
+    std::unique_ptr<ParserBase> static_limited = make_parser(limited);
+    NormalParser runtime_unlimited(unlimited);
+    std::unique_ptr<ParserBase> static_unlimited = make_parser(unlimited);
+    BasicParser<StaticPolicy<false, false>> bare(unlimited);
+    std::unique_ptr<ParserBase> static_defaults = make_parser(ParserSettings{});
+
+    run("runtime policy, limits", runtime_limited, json, rounds);
+    run("static policy, limits", *static_limited, json, rounds);
+    run("runtime policy, unlimited settings", runtime_unlimited, json, rounds);
+    run("static policy, checks compiled out", *static_unlimited, json, rounds);
+    run("static policy, no checks/comments", bare, json, rounds);
+    run("static policy, default settings", *static_defaults, json, rounds);
+    return 0;
+}
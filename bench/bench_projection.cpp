@@ -0,0 +1,73 @@
+#include "parser_impl.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using SimpleJsonParser::NormalParser;
+using SimpleJsonParser::ParserSettings;
+using SimpleJsonParser::Projection;
+
+static const size_t num_fields = 10;
+
+/* Records with ten fields of similar size, so selecting fields maps to selectivity */
+static std::string make_corpus(size_t target_bytes, size_t& num_records) {
+    std::string json = "[";
+    for(num_records = 0; json.size() < target_bytes; ++num_records) {
+        if(num_records != 0)
+            json += ",";
+        json += "{";
+        for(size_t f = 0; f < num_fields; ++f) {
+            if(f != 0)
+                json += ", ";
+            json += "\"f" + std::to_string(f) + "\": ";
+            if(f % 2 == 0)
+                json += "{\"v\": " + std::to_string(num_records + f) + ".5, \"s\": \"value\"}";
+            else
+                json += "[\"text " + std::to_string(num_records) + "\", 1, 2]";
+        }
+        json += "}";
+    }
+    json += "]";
+    return json;
+}
+
+static void run(const char* label, const std::vector<std::string>& pointers, const std::string& json, int rounds) {
+    ParserSettings settings;
+    settings.max_array_length = 1 << 24;
+    settings.projection = Projection::compile(pointers);
+    NormalParser parser(settings);
+
+    double best = 1e30;
+    for(int i = 0; i < rounds; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        bool error = parser.parse(json).m_error_info.is_error();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if(error) {
+            std::printf("%s: parse error\n", label);
+            return;
+        }
+        best = seconds < best ? seconds : best;
+    }
+    std::printf("%-28s %.3f s, %.1f MB/s\n", label, best, json.size() / best / 1e6);
+}
+
+int main() {
+    const int rounds = 5;
+    size_t num_records;
+    std::string json = make_corpus(32 * 1000 * 1000, num_records);
+
+    std::vector<std::string> one_percent;
+    for(size_t i = 0; i < num_records; i += 10)
+        one_percent.push_back("/" + std::to_string(i) + "/f0");
+
+    std::vector<std::string> half;
+    for(size_t f = 0; f < num_fields / 2; ++f)
+        half.push_back("/*/f" + std::to_string(f));
+
+    run("full parse", {}, json, rounds);
+    run("projection, ~1% selected", one_percent, json, rounds);
+    run("projection, ~10% selected", {"/*/f0"}, json, rounds);
+    run("projection, ~50% selected", half, json, rounds);
+    return 0;
+}
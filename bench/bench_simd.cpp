@@ -0,0 +1,76 @@
+#include "parser_impl.hpp"
+#include "simd.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using SimpleJsonParser::Kernels;
+using SimpleJsonParser::NormalParser;
+using SimpleJsonParser::SimdLevel;
+using SimpleJsonParser::detect_simd_level;
+using SimpleJsonParser::kernels_for;
+using SimpleJsonParser::set_simd_level;
+
+static const char* level_name(SimdLevel level) {
+    switch(level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::SSE42: return "sse4.2";
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+    }
+    return "?";
+}
+
+/* Pretty-printed records with long string fields */
+static std::string make_corpus(size_t target_bytes) {
+    std::string json = "[\n";
+    for(size_t i = 0; json.size() < target_bytes; ++i) {
+        if(i != 0)
+            json += ",\n";
+        json += "    {\n        \"id\": " + std::to_string(i) + ",\n        \"description\": \"" + std::string(80 + i % 120, 'd') +
+            "\",\n        \"path\": \"C:\\\\data\\\\item" + std::to_string(i) + "\",\n        \"values\": [1, 2, 3]\n    }";
+    }
+    json += "\n]";
+    return json;
+}
+
+template<typename F>
+static double best_of(int rounds, F f) {
+    double best = 1e30;
+    for(int i = 0; i < rounds; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = seconds < best ? seconds : best;
+    }
+    return best;
+}
+
+int main() {
+    const int rounds = 5;
+    std::string json = make_corpus(32 * 1000 * 1000);
+    std::string ws(json.size(), ' ');
+    std::string text(json.size(), 'a');
+    std::vector<uint32_t> index(json.size());
+    const double mb = json.size() / 1e6;
+
+    std::printf("%-8s %12s %12s %12s %12s %12s\n", "level", "ws MB/s", "string MB/s", "index MB/s", "utf8 MB/s", "parse MB/s");
+    for(SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if(!set_simd_level(level))
+            continue;
+        const Kernels& k = kernels_for(level);
+
+        volatile const char* sink = nullptr;
+        double t_ws = best_of(rounds, [&] { sink = k.skip_whitespace(ws.data(), ws.data() + ws.size()); });
+        double t_str = best_of(rounds, [&] { sink = k.scan_string(text.data(), text.data() + text.size()); });
+        double t_idx = best_of(rounds, [&] { k.structural_index(json.data(), json.data() + json.size(), index.data()); });
+        double t_utf8 = best_of(rounds, [&] { k.validate_utf8(json.data(), json.data() + json.size()); });
+        double t_parse = best_of(rounds, [&] { NormalParser parser; parser.parse(json); });
+        (void)sink;
+
+        std::printf("%-8s %12.0f %12.0f %12.0f %12.0f %12.1f\n", level_name(level),
+            mb / t_ws, mb / t_str, mb / t_idx, mb / t_utf8, mb / t_parse);
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "mappedfile.hpp"
+#include "parser_impl.hpp"
+#include "stream_input.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <zlib.h>
+
+using SimpleJsonParser::MemoryMappedFile;
+using SimpleJsonParser::NdjsonReader;
+using SimpleJsonParser::NormalParser;
+using SimpleJsonParser::PipelinedArrayReader;
+using SimpleJsonParser::PipelinedInput;
+using SimpleJsonParser::Value;
+using SimpleJsonParser::open_input_source;
+using SimpleJsonParser::parse_document;
+
+static std::string make_ndjson(size_t target_bytes) {
+    std::string text;
+    for(size_t i = 0; text.size() < target_bytes; ++i) {
+        text += "{\"id\": " + std::to_string(i) + ", \"user\": \"user" + std::to_string(i % 5000) +
+            "\", \"event\": \"click\", \"value\": " + std::to_string(i % 977) + ".5, \"tags\": [\"a\", \"b\"]}\n";
+    }
+    return text;
+}
+
+static void write_gzip(const std::string& path, const std::string& text) {
+    gzFile out = gzopen(path.c_str(), "wb6");
+    gzwrite(out, text.data(), static_cast<unsigned>(text.size()));
+    gzclose(out);
+}
+
+/* The current workflow: decompress to a temporary file, then map it */
+static void decompress_to_file(const std::string& from, const std::string& to) {
+    std::unique_ptr<SimpleJsonParser::InputSource> source = open_input_source(from);
+    std::FILE* out = std::fopen(to.c_str(), "wb");
+    std::string buffer(1 << 20, '\0');
+    size_t size;
+    while((size = source->read(&buffer[0], buffer.size())) != 0) {
+        std::fwrite(buffer.data(), 1, size, out);
+    }
+    std::fclose(out);
+}
+
+template<typename F>
+static double measure(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 128;
+    const std::string gz_path = "/tmp/simple_json_parser_bench.ndjson.gz";
+    const std::string doc_path = "/tmp/simple_json_parser_bench.json.gz";
+    const std::string tmp_path = "/tmp/simple_json_parser_bench.tmp";
+
+    std::string ndjson = make_ndjson(megabytes * 1000 * 1000);
+    const double mb = ndjson.size() / 1e6;
+    write_gzip(gz_path, ndjson);
+
+    std::string document = "[" + ndjson + "]";
+    for(size_t pos = document.find('\n'); pos + 2 < document.size(); pos = document.find('\n', pos + 1)) {
+        document[pos] = ',';
+    }
+    document[document.size() - 2] = ' ';
+    write_gzip(doc_path, document);
+    ndjson.clear();
+    ndjson.shrink_to_fit();
+
+    size_t lines = 0;
+    double t_file = measure([&] {
+        decompress_to_file(gz_path, tmp_path);
+        MemoryMappedFile file;
+        file.open_file(tmp_path);
+        NormalParser parser;
+        const char* cur = file.begin();
+        while(cur < file.end()) {
+            const char* newline = static_cast<const char*>(std::memchr(cur, '\n', file.end() - cur));
+            const char* end = newline != nullptr ? newline : file.end();
+            lines += !parser.parse(cur, end).m_error_info.is_error();
+            cur = end + 1;
+        }
+    });
+    std::remove(tmp_path.c_str());
+    std::printf("ndjson    decompress-then-parse: %zu lines, %.3f s, %.1f MB/s\n", lines, t_file, mb / t_file);
+
+    lines = 0;
+    double t_pipe = measure([&] {
+        PipelinedInput input(open_input_source(gz_path));
+        NdjsonReader reader(input);
+        for(Value& value : reader) {
+            lines += value.is_object();
+        }
+    });
+    std::printf("ndjson    pipelined:             %zu lines, %.3f s, %.1f MB/s\n", lines, t_pipe, mb / t_pipe);
+
+    double t_doc_file = measure([&] {
+        decompress_to_file(doc_path, tmp_path);
+        MemoryMappedFile file;
+        file.open_file(tmp_path);
+        NormalParser parser;
+        parser.parse(file.begin(), file.end());
+    });
+    std::remove(tmp_path.c_str());
+    std::printf("document  decompress-then-parse: %.3f s, %.1f MB/s\n", t_doc_file, mb / t_doc_file);
+
+    double t_doc_gather = measure([&] {
+        PipelinedInput input(open_input_source(doc_path));
+        NormalParser parser;
+        parse_document(input, parser);
+    });
+    std::printf("document  gathered, then parsed: %.3f s, %.1f MB/s\n", t_doc_gather, mb / t_doc_gather);
+
+    size_t elements = 0;
+    double t_doc_pipe = measure([&] {
+        PipelinedInput input(open_input_source(doc_path));
+        PipelinedArrayReader reader(input);
+        for(Value& value : reader) {
+            elements += value.is_object();
+        }
+    });
+    std::printf("document  pipelined elements:    %zu elements, %.3f s, %.1f MB/s\n", elements, t_doc_pipe, mb / t_doc_pipe);
+
+    std::remove(gz_path.c_str());
+    std::remove(doc_path.c_str());
+    return 0;
+}
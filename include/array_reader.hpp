@@ -0,0 +1,290 @@
+#ifndef SIMPLE_JSON_PARSER_ARRAY_READER
+#define SIMPLE_JSON_PARSER_ARRAY_READER
+
+#include "error.hpp"
+#include "document.hpp"
+#include "mappedfile.hpp"
+#include "parser_impl.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace SimpleJsonParser {
+
+    /*
+     * Input iterator over any reader with a bool next(Value&) member. Copies share
+     * the current element, so advancing one of them invalidates the others.
+     */
+    template<typename Reader>
+    class ElementIterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = Value;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value*;
+            using reference = Value&;
+
+            ElementIterator() : m_reader(nullptr) {}
+            explicit ElementIterator(Reader* reader) : m_reader(reader), m_value(std::make_shared<Value>()) { advance(); }
+
+            Value& operator*() const { return *m_value; }
+            Value* operator->() const { return m_value.get(); }
+
+            ElementIterator& operator++() {
+                advance();
+                return *this;
+            }
+
+            /* Keeps the element a postfix increment moves past, so *it++ still reads it */
+            class Previous {
+                public:
+                    explicit Previous(Value value) : m_value(std::move(value)) {}
+                    Value& operator*() { return m_value; }
+
+                private:
+                    Value m_value;
+            };
+
+            Previous operator++(int) {
+                Previous previous(std::move(*m_value));
+                advance();
+                return previous;
+            }
+
+            bool operator==(const ElementIterator& other) const { return m_reader == other.m_reader; }
+            bool operator!=(const ElementIterator& other) const { return m_reader != other.m_reader; }
+
+        private:
+            void advance() {
+                if(m_reader != nullptr && !m_reader->next(*m_value)) {
+                    m_reader = nullptr;
+                }
+            }
+
+            Reader* m_reader;
+            std::shared_ptr<Value> m_value;
+    };
+
+    /*
+     * Pulls the elements of a top-level array one at a time, so only the element
+     * being handed out is materialized. When reading from a MemoryMappedFile, the
+     * pages behind already consumed elements are dropped every release_interval bytes.
+     * Elements outside the projection in the settings are validated but not returned.
+     */
+    class ArrayElementReader : protected NormalParser {
+        public:
+            using Iterator = ElementIterator<ArrayElementReader>;
+
+            static constexpr size_t default_release_interval = 64 * 1024 * 1024;
+
+            ArrayElementReader(const char* begin, const char* end, const ParserSettings& settings=ParserSettings())
+                : NormalParser(settings), m_file(nullptr) {
+                init_parser_state(begin, end);
+                m_released = begin;
+            }
+
+            explicit ArrayElementReader(const MemoryMappedFile& file, size_t release_interval=default_release_interval,
+                                        const ParserSettings& settings=ParserSettings())
+                : NormalParser(settings), m_file(&file), m_release_interval(release_interval) {
+                init_parser_state(file.begin(), file.end());
+                m_released = file.begin();
+            }
+
+            /* Returns false once the array is exhausted or malformed; error_info() tells the two apart. */
+            bool next(Value& value);
+
+            const ErrorInfo& error_info() const { return m_error_info; }
+
+            Iterator begin() { return Iterator(this); }
+            Iterator end() { return Iterator(); }
+
+        private:
+            void fail(ErrorCode error_code) {
+                set_error(error_code);
+                m_finished = true;
+            }
+
+            void release_consumed() {
+                if(m_file != nullptr && static_cast<size_t>(m_cur - m_released) >= m_release_interval) {
+                    m_file->release(m_released, m_cur);
+                    m_released = m_cur;
+                }
+            }
+
+            const char* m_released;
+            const MemoryMappedFile* m_file;
+            size_t m_release_interval = default_release_interval;
+            /* Index of the next element, for the projection */
+            size_t m_index = 0;
+            bool m_started = false;
+            bool m_finished = false;
+    };
+
+    inline bool ArrayElementReader::next(Value& value) {
+        if(m_finished) {
+            return false;
+        }
+
+        if(!m_started) {
+            m_started = true;
+            skip_whitespace();
+            if(m_cur == m_end || *m_cur != '[') {
+                fail(ErrorCode::eNoCorrespondingValue);
+                return false;
+            }
+            ++m_cur;
+            /* The array itself counts towards the depth limit, as in parse_array */
+            if(++m_depth > settings().max_depth_object) {
+                fail(ErrorCode::eObjectDepthLimitExceed);
+                return false;
+            }
+
+            skip_whitespace();
+            if(m_cur != m_end && *m_cur == ']') {
+                ++m_cur;
+                m_finished = true;
+                return false;
+            }
+        }
+
+        size_t node = settings().projection.start();
+        while(!m_finished) {
+            size_t child = node == Projection::all ? Projection::all : settings().projection.element(node, m_index);
+            ++m_index;
+
+            bool selected = !skip_projected(child);
+            if(selected) {
+                value = parse_value(child);
+                if(value.type() == ValueType::Uninitialized) {
+                    fail(ErrorCode::eNoCorrespondingValue);
+                    return false;
+                }
+            }
+            else if(!skip_value()) {
+                fail(ErrorCode::eNoCorrespondingValue);
+                return false;
+            }
+
+            if(m_cur != m_end && *m_cur == ',') {
+                ++m_cur;
+            }
+            else if(m_cur != m_end && *m_cur == ']') {
+                ++m_cur;
+                m_finished = true;
+            }
+            else {
+                set_unexpected_error(ErrorCode::eMissingCommaOrSquareBracket);
+                m_finished = true;
+                value = Value();
+                return false;
+            }
+
+            release_consumed();
+            if(selected) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*
+     * Runs an ArrayElementReader on a worker thread that parses up to
+     * max_pending elements ahead of the consumer. The consumer holds at most
+     * another max_pending elements it has taken over but not returned yet.
+     */
+    class ReadAheadArrayReader {
+        public:
+            using Iterator = ElementIterator<ReadAheadArrayReader>;
+
+            ReadAheadArrayReader(const char* begin, const char* end, size_t max_pending=1)
+                : m_reader(begin, end), m_max_pending(max_pending) {
+                start();
+            }
+
+            explicit ReadAheadArrayReader(const MemoryMappedFile& file, size_t max_pending=1)
+                : m_reader(file), m_max_pending(max_pending) {
+                start();
+            }
+
+            ReadAheadArrayReader(const ReadAheadArrayReader&) = delete;
+            ReadAheadArrayReader& operator=(const ReadAheadArrayReader&) = delete;
+
+            ~ReadAheadArrayReader() {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stopped = true;
+                }
+                m_not_full.notify_all();
+                m_worker.join();
+            }
+
+            bool next(Value& value) {
+                if(m_ready.empty()) {
+                    /* Take every pending element at once to keep lock handoffs off the per-element path */
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_not_empty.wait(lock, [this] { return !m_pending.empty() || m_done; });
+                    if(m_pending.empty()) {
+                        return false;
+                    }
+                    m_ready.swap(m_pending);
+                    lock.unlock();
+                    m_not_full.notify_one();
+                }
+
+                value = std::move(m_ready.front());
+                m_ready.pop_front();
+                return true;
+            }
+
+            /* Only meaningful after next() has returned false */
+            const ErrorInfo& error_info() const { return m_reader.error_info(); }
+
+            Iterator begin() { return Iterator(this); }
+            Iterator end() { return Iterator(); }
+
+        private:
+            void start() {
+                m_worker = std::thread([this] { produce(); });
+            }
+
+            void produce() {
+                Value value;
+                while(m_reader.next(value)) {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_not_full.wait(lock, [this] { return m_pending.size() < m_max_pending || m_stopped; });
+                    if(m_stopped) {
+                        break;
+                    }
+                    m_pending.push_back(std::move(value));
+                    bool was_empty = m_pending.size() == 1;
+                    lock.unlock();
+                    if(was_empty) {
+                        m_not_empty.notify_one();
+                    }
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_done = true;
+                }
+                m_not_empty.notify_all();
+            }
+
+            ArrayElementReader m_reader;
+            size_t m_max_pending;
+            std::deque<Value> m_pending;
+            std::deque<Value> m_ready;
+            std::mutex m_mutex;
+            std::condition_variable m_not_empty;
+            std::condition_variable m_not_full;
+            bool m_stopped = false;
+            bool m_done = false;
+            std::thread m_worker;
+    };
+}
+
+#endif
@@ -2,6 +2,10 @@
 #define SIMPLE_JSON_PARSER_DOCUMENT
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <vector>
 #include <map>
 #include <utility>
@@ -35,16 +39,99 @@ namespace SimpleJsonParser {
         {ValueType::Null, "Null"},
     };
 
-     std::ostream& operator<<(std::ostream& s, ValueType type) {
+    inline std::ostream& operator<<(std::ostream& s, ValueType type) {
         return s << ValueTypeToString[type];
     }
 
+    namespace detail {
+        /* splitmix64 finalizer */
+        inline uint64_t mix_hash(uint64_t x) noexcept {
+            x ^= x >> 30;
+            x *= 0xbf58476d1ce4e5b9ULL;
+            x ^= x >> 27;
+            x *= 0x94d049bb133111ebULL;
+            x ^= x >> 31;
+            return x;
+        }
+
+        /* FNV-1a, so the result does not depend on the standard library */
+        inline uint64_t hash_bytes(const char* data, size_t size) noexcept {
+            uint64_t h = 0xcbf29ce484222325ULL;
+            for(size_t i = 0; i < size; ++i) {
+                h ^= static_cast<unsigned char>(data[i]);
+                h *= 0x100000001b3ULL;
+            }
+            return mix_hash(h);
+        }
+
+        /* Array or object storage with its structural hash cached alongside, so clones sharing it share the cache */
+        template<typename Container>
+        struct HashedStorage {
+            Container items;
+            mutable std::atomic<uint64_t> hash{0};
+            mutable std::atomic<bool> hash_cached{false};
+        };
+    }
+
+    /* Heap held by a value tree, as reported by Value::memory_summary(). Storage shared with clones is counted for every node referring to it. */
+    struct MemoryUsage {
+        size_t num_nodes = 0;
+        size_t num_strings = 0;
+        size_t num_arrays = 0;
+        size_t num_objects = 0;
+        size_t node_bytes = 0;       /* sizeof(Value) for every node */
+        size_t string_bytes = 0;     /* string objects and their character buffers, keys included */
+        size_t container_bytes = 0;  /* vector buffers beyond the elements, map objects and tree nodes */
+        size_t slack_bytes = 0;      /* unused capacity, already part of string_bytes and container_bytes */
+
+        size_t total_bytes() const { return node_bytes + string_bytes + container_bytes; }
+    };
+
+    /*
+     * Strings, arrays and objects live in reference-counted storage that is shared
+     * between clones. clone() is O(1); a mutating accessor first gives the node its
+     * own copy of the storage if it is shared, which copies only the handles of the
+     * children. Mutating a deep member this way copies only the nodes on the path
+     * to it. Shared subtrees may be read from several threads at once.
+     *
+     * A reference or iterator from the non-const operator[], begin() or end() may
+     * outlive the call, so it marks the node unshareable: clone() copies that node's
+     * storage instead of sharing it, and writes through the reference never reach
+     * a clone. Trees built with push_back() and add_member() stay O(1) to clone.
+     */
     class Value {
     public:
 
         using ValueIterator = Value*;
+        using ConstValueIterator = const Value*;
+        using ArrayStorage = detail::HashedStorage<std::vector<Value>>;
+        using ObjectStorage = detail::HashedStorage<std::map<std::string, Value>>;
 
         Value() : m_type(ValueType::Uninitialized) {}
+
+        Value(const Value&) = delete;
+        Value& operator=(const Value&) = delete;
+
+        Value(Value&& other) noexcept
+            : string_ptr(std::move(other.string_ptr)), array_ptr(std::move(other.array_ptr)), object_ptr(std::move(other.object_ptr)),
+              m_data(other.m_data), m_type(other.m_type), m_unshareable(other.m_unshareable) {
+            other.m_type = ValueType::Uninitialized;
+            other.m_unshareable = false;
+        }
+
+        Value& operator=(Value&& other) noexcept {
+            if(this != &other) {
+                string_ptr = std::move(other.string_ptr);
+                array_ptr = std::move(other.array_ptr);
+                object_ptr = std::move(other.object_ptr);
+                m_data = other.m_data;
+                m_type = other.m_type;
+                m_unshareable = other.m_unshareable;
+                other.m_type = ValueType::Uninitialized;
+                other.m_unshareable = false;
+            }
+            return *this;
+        }
         
         Value(ValueType type): m_type(type) { 
             if(type == ValueType::Integer) {
@@ -54,13 +141,13 @@ namespace SimpleJsonParser {
                 m_data.fraction = 0.0;
             }
             else if(type == ValueType::String) {
-                string_ptr = std::make_unique<std::string>("");
+                string_ptr = std::make_shared<std::string>("");
             }
             else if(type == ValueType::Array) {
-                array_ptr = std::make_unique<std::vector<Value>>();
+                array_ptr = std::make_shared<ArrayStorage>();
             }
             else if(type == ValueType::Object) {
-                object_ptr = std::make_unique<std::map<std::string, Value>>();
+                object_ptr = std::make_shared<ObjectStorage>();
             }
             else if(type == ValueType::Boolean) {
                 m_data.boolean = false;
@@ -76,12 +163,11 @@ namespace SimpleJsonParser {
         }
 
         Value(const char* str) : m_type(ValueType::String) {
-            string_ptr = std::make_unique<std::string>(str);
+            string_ptr = std::make_shared<std::string>(str);
         }
         
         Value(const std::string& str) : m_type(ValueType::String) {
-            string_ptr = std::make_unique<std::string>("");
-            *string_ptr = str;
+            string_ptr = std::make_shared<std::string>(str);
         }
 
         Value(bool val) : m_type(ValueType::Boolean) {
@@ -106,10 +192,14 @@ namespace SimpleJsonParser {
                 return *(string_ptr) == *(other.string_ptr);
             }
             else if(m_type == ValueType::Array) {
-                return *(array_ptr) == *(other.array_ptr);
+                if(array_ptr == other.array_ptr)
+                    return true;
+                return array_ptr->items == other.array_ptr->items;
             }
             else if(m_type == ValueType::Object) {
-                return *(object_ptr) == *(other.object_ptr);
+                if(object_ptr == other.object_ptr)
+                    return true;
+                return object_ptr->items == other.object_ptr->items;
             }
             else if(m_type == ValueType::Boolean) {
                 return m_data.boolean == other.boolean();
@@ -121,39 +211,99 @@ namespace SimpleJsonParser {
             return true;
         }
 
-        Value clone() const {
+        /*
+         * Stable 64-bit structural hash. Equal values always have equal hashes,
+         * and objects hash independently of member order. The result is cached
+         * in array and object storage, shared with clones; mutating members through the accessors
+         * drops the cache, but a reference kept from before hash() was called
+         * must not be used to mutate the tree afterwards.
+         */
+        uint64_t hash() const {
             if(m_type == ValueType::Integer) {
-                return Value(m_data.integer);
-            } 
-            else if(m_type == ValueType::Fraction){
-                return Value(m_data.fraction);
+                return detail::mix_hash(static_cast<uint64_t>(m_data.integer) ^ 0x1ULL);
+            }
+            else if(m_type == ValueType::Fraction) {
+                double val = m_data.fraction == 0.0 ? 0.0 : m_data.fraction;
+                uint64_t bits;
+                std::memcpy(&bits, &val, sizeof(bits));
+                return detail::mix_hash(bits ^ 0x2ULL);
             }
             else if(m_type == ValueType::String) {
+                return detail::hash_bytes(string_ptr->data(), string_ptr->size()) ^ 0x4ULL;
+            }
+            else if(m_type == ValueType::Array) {
+                return cached_hash(*array_ptr);
+            }
+            else if(m_type == ValueType::Object) {
+                return cached_hash(*object_ptr);
+            }
+            else if(m_type == ValueType::Boolean) {
+                return detail::mix_hash(m_data.boolean ? 0x21ULL : 0x20ULL);
+            }
+            else if(m_type == ValueType::Null) {
+                return detail::mix_hash(0x40ULL);
+            }
+
+            return detail::mix_hash(0);
+        }
+
+        /* Equality that rejects mismatching arrays and objects by their hash first. */
+        bool equals(const Value& other) const {
+            if(m_type != other.m_type)
+                return false;
+
+            if((m_type == ValueType::Array || m_type == ValueType::Object) && hash() != other.hash())
+                return false;
+
+            return *this == other;
+        }
+
+        /*
+         * O(1): the copy shares this node's storage until either side is mutated.
+         * Unshareable nodes are copied one level down, their children cloned in turn.
+         */
+        Value clone() const {
+            Value temp;
+            temp.string_ptr = string_ptr;
+            temp.array_ptr = array_ptr;
+            temp.object_ptr = object_ptr;
+            temp.m_data = m_data;
+            temp.m_type = m_type;
+            if(m_unshareable) {
+                temp.copy_storage();
+            }
+            return temp;
+        }
+
+        /* Copies the whole tree into new, unshared and exactly sized storage */
+        Value deep_clone() const {
+            if(m_type == ValueType::String) {
                 return Value(*string_ptr);
             }
             else if(m_type == ValueType::Array) {
                 Value temp = Value(ValueType::Array);
-                for(const Value& val : *array_ptr) {
-                    temp.push_back(val.clone());
+                temp.array_ptr->items.reserve(array_ptr->items.size());
+                for(const Value& val : array_ptr->items) {
+                    temp.array_ptr->items.push_back(val.deep_clone());
                 }
                 return temp;
             }
             else if(m_type == ValueType::Object) {
                 Value temp = Value(ValueType::Object);
-                for(const auto& val : *object_ptr) {
-                   temp.add_member(val.first, val.second);
+                for(const auto& member : object_ptr->items) {
+                    temp.object_ptr->items.emplace_hint(temp.object_ptr->items.end(), member.first, member.second.deep_clone());
                 }
-
                 return temp;
             }
-            else if(m_type == ValueType::Boolean) {
-                return Value(m_data.boolean);
-            }
-            else if(m_type == ValueType::Null) {
-                return Value(ValueType::Null);
-            }
 
-            return Value();
+            return clone();
+        }
+
+        /* Whether this node shares its storage with a clone */
+        bool is_shared() const {
+            return (string_ptr && string_ptr.use_count() > 1)
+                || (array_ptr && array_ptr.use_count() > 1)
+                || (object_ptr && object_ptr.use_count() > 1);
         }
         
         bool is_uninitialized() const { return m_type == ValueType::Uninitialized; }
@@ -197,64 +347,126 @@ namespace SimpleJsonParser {
 
         void set_string(const std::string& str) {
             check_type(ValueType::String);
-            *string_ptr = str;
+            string_ptr = std::make_shared<std::string>(str);
         }
 
         void set_string(std::string&& str) {
             check_type(ValueType::String);
-            *string_ptr = std::move(str);
+            string_ptr = std::make_shared<std::string>(std::move(str));
         }
 
         /* Array */
         void push_back(Value&& member) {
             check_type(ValueType::Array);
-            array_ptr->push_back(std::move(member));
+            detach();
+            /* References into the member's storage now point into this node's */
+            m_unshareable = m_unshareable || member.m_unshareable;
+            array_ptr->items.push_back(std::move(member));
         }
 
         void push_back(const Value& member) {
             check_type(ValueType::Array);
-            array_ptr->push_back(member.clone());
+            detach();
+            array_ptr->items.push_back(member.clone());
+        }
+
+        size_t size_array() const {
+            check_type(ValueType::Array);
+            return array_ptr->items.size();
+        }
+
+        ValueIterator begin() {
+            check_type(ValueType::Array);
+            detach();
+            m_unshareable = true;
+            return this->array_ptr->items.data();
         }
 
-        size_t size_array() {
+        ValueIterator end() {
             check_type(ValueType::Array);
-            return array_ptr->size();
+            detach();
+            m_unshareable = true;
+            return this->array_ptr->items.data() + this->array_ptr->items.size();
         }
 
-        ValueIterator begin() const {
+        ConstValueIterator begin() const {
             check_type(ValueType::Array);
-            return this->array_ptr->data();
+            return this->array_ptr->items.data();
         }
 
-        ValueIterator end() const {
+        ConstValueIterator end() const {
             check_type(ValueType::Array);
-            return this->array_ptr->data() + this->array_ptr->size();
+            return this->array_ptr->items.data() + this->array_ptr->items.size();
         }
 
-        Value& operator[](size_t index) const {
+        Value& operator[](size_t index) {
             check_type(ValueType::Array);
-            return (*array_ptr)[index];
+            detach();
+            m_unshareable = true;
+            return array_ptr->items[index];
+        }
+
+        const Value& operator[](size_t index) const {
+            check_type(ValueType::Array);
+            return array_ptr->items[index];
         }
 
         /* Object  */
         void add_member(const std::string& key, Value&& member) {
             check_type(ValueType::Object);
-            (*object_ptr)[key] = std::move(member);
+            detach();
+            m_unshareable = m_unshareable || member.m_unshareable;
+            object_ptr->items[key] = std::move(member);
         }
 
         void add_member(const std::string& key, const Value& member) {
             check_type(ValueType::Object);
-            (*object_ptr)[key] = member.clone();
+            detach();
+            object_ptr->items[key] = member.clone();
         }
         
-        Value& operator[](const std::string& key) const {
+        Value& operator[](const std::string& key) {
             check_type(ValueType::Object);
-            return (*object_ptr)[key];
+            detach();
+            m_unshareable = true;
+            return object_ptr->items[key];
         }
 
-        size_t size_object() {
+        /* Throws std::out_of_range if the member does not exist */
+        const Value& operator[](const std::string& key) const {
             check_type(ValueType::Object);
-            return object_ptr->size();
+            return object_ptr->items.at(key);
+        }
+
+        size_t size_object() const {
+            check_type(ValueType::Object);
+            return object_ptr->items.size();
+        }
+
+        /* Memory */
+        MemoryUsage memory_summary() const {
+            MemoryUsage usage;
+            usage.node_bytes += sizeof(Value);
+            ++usage.num_nodes;
+            collect_memory_usage(usage);
+            return usage;
+        }
+
+        size_t memory_usage() const {
+            return memory_summary().total_bytes();
+        }
+
+        /*
+         * Rebuilds the tree with exactly sized strings and arrays. The copy is
+         * allocated in one pass before the old tree is released, so nodes end up
+         * next to each other and the old allocations are freed together. Peak
+         * memory is twice the size of the tree while compacting. The rebuilt tree
+         * no longer shares storage with earlier clones, so compacting a tree that
+         * has live clones can increase the total memory held.
+         */
+        void compact() {
+            Value compacted = deep_clone();
+            *this = std::move(compacted);
         }
                 
     private:
@@ -263,16 +475,139 @@ namespace SimpleJsonParser {
                 throw std::runtime_error("The value type is not " + ValueTypeToString[type]);
         }
 
+        static size_t string_heap_bytes(const std::string& str) {
+            static const size_t sso_capacity = std::string().capacity();
+            return str.capacity() > sso_capacity ? str.capacity() + 1 : 0;
+        }
+
+        static size_t string_slack_bytes(const std::string& str) {
+            return string_heap_bytes(str) != 0 ? str.capacity() - str.size() : 0;
+        }
+
+        /* Adds everything owned by this node except the node itself */
+        void collect_memory_usage(MemoryUsage& usage) const {
+            if(m_type == ValueType::String) {
+                ++usage.num_strings;
+                usage.string_bytes += sizeof(std::string) + string_heap_bytes(*string_ptr);
+                usage.slack_bytes += string_slack_bytes(*string_ptr);
+            }
+            else if(m_type == ValueType::Array) {
+                size_t slack = (array_ptr->items.capacity() - array_ptr->items.size()) * sizeof(Value);
+                ++usage.num_arrays;
+                usage.container_bytes += sizeof(ArrayStorage) + slack;
+                usage.slack_bytes += slack;
+                for(const Value& val : array_ptr->items) {
+                    usage.node_bytes += sizeof(Value);
+                    ++usage.num_nodes;
+                    val.collect_memory_usage(usage);
+                }
+            }
+            else if(m_type == ValueType::Object) {
+                /* Red-black tree node header: color and three links */
+                const size_t map_node_overhead = 4 * sizeof(void*);
+                ++usage.num_objects;
+                usage.container_bytes += sizeof(ObjectStorage);
+                for(const auto& member : object_ptr->items) {
+                    usage.container_bytes += map_node_overhead;
+                    usage.string_bytes += sizeof(std::string) + string_heap_bytes(member.first);
+                    usage.slack_bytes += string_slack_bytes(member.first);
+                    usage.node_bytes += sizeof(Value);
+                    ++usage.num_nodes;
+                    member.second.collect_memory_usage(usage);
+                }
+            }
+        }
+
+        /*
+         * Called before every mutation of an array or object: gives this node its
+         * own storage if a clone shares it, and drops the cached hash.
+         */
+        void detach() {
+            if((array_ptr && array_ptr.use_count() > 1) || (object_ptr && object_ptr.use_count() > 1)) {
+                copy_storage();
+            }
+            else {
+                /* Sole owner: make the other owners' last accesses visible before writing */
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(array_ptr) {
+                    array_ptr->hash_cached.store(false, std::memory_order_relaxed);
+                }
+                else if(object_ptr) {
+                    object_ptr->hash_cached.store(false, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /* Replaces an array's or object's storage with a copy holding clones of the children */
+        void copy_storage() {
+            if(array_ptr) {
+                auto copy = std::make_shared<ArrayStorage>();
+                copy->items.reserve(array_ptr->items.size());
+                for(const Value& val : array_ptr->items) {
+                    copy->items.push_back(val.clone());
+                }
+                array_ptr = std::move(copy);
+            }
+            else if(object_ptr) {
+                auto copy = std::make_shared<ObjectStorage>();
+                for(const auto& member : object_ptr->items) {
+                    copy->items.emplace_hint(copy->items.end(), member.first, member.second.clone());
+                }
+                object_ptr = std::move(copy);
+            }
+        }
+
+        /* Threads sharing the storage may race here, but they all store the same hash */
+        template<typename Storage>
+        uint64_t cached_hash(const Storage& storage) const {
+            if(storage.hash_cached.load(std::memory_order_acquire)) {
+                return storage.hash.load(std::memory_order_relaxed);
+            }
+            uint64_t h = hash_container();
+            storage.hash.store(h, std::memory_order_relaxed);
+            storage.hash_cached.store(true, std::memory_order_release);
+            return h;
+        }
+
+        uint64_t hash_container() const {
+            if(m_type == ValueType::Array) {
+                uint64_t h = 0x8ULL;
+                for(const Value& val : array_ptr->items) {
+                    h = detail::mix_hash(h + val.hash());
+                }
+                return detail::mix_hash(h ^ array_ptr->items.size());
+            }
+
+            /* Members are summed so that the order they are visited in does not matter */
+            uint64_t h = 0;
+            for(const auto& member : object_ptr->items) {
+                uint64_t key_hash = detail::hash_bytes(member.first.data(), member.first.size());
+                h += detail::mix_hash(key_hash + detail::mix_hash(member.second.hash()));
+            }
+            return detail::mix_hash(h ^ 0x10ULL ^ object_ptr->items.size());
+        }
+
         union Data  {
             bool boolean;
             int64_t integer;
             double fraction;
         };
-        std::unique_ptr<std::string> string_ptr;
-        std::unique_ptr<std::vector<Value>> array_ptr;
-        std::unique_ptr<std::map<std::string, Value>> object_ptr;
-        union Data m_data;
+        std::shared_ptr<std::string> string_ptr;
+        std::shared_ptr<ArrayStorage> array_ptr;
+        std::shared_ptr<ObjectStorage> object_ptr;
+        union Data m_data{};
         ValueType m_type;
+        /* Set once a mutable reference into the storage has been handed out */
+        bool m_unshareable = false;
+    };
+}
+
+namespace std {
+    template<>
+    struct hash<SimpleJsonParser::Value> {
+        size_t operator()(const SimpleJsonParser::Value& value) const noexcept {
+            return static_cast<size_t>(value.hash());
+        }
     };
 }
 
@@ -39,6 +39,7 @@ namespace SimpleJsonParser {
 
         /* Value format error */
         eNoCorrespondingValue,
+        eExtraCharactersAfterValue,
     };
 
     class ErrorInfo {
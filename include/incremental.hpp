@@ -0,0 +1,208 @@
+#ifndef SIMPLE_JSON_PARSER_INCREMENTAL
+#define SIMPLE_JSON_PARSER_INCREMENTAL
+
+#include "error.hpp"
+#include "document.hpp"
+#include "parser_impl.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace SimpleJsonParser {
+
+    /*
+     * Keeps a document's text, its parsed value and the spans of its containers so
+     * that small edits only reparse the innermost array or object around them.
+     * An edit that touches the brackets of every container around it, or leaves
+     * the enclosing container unparseable on its own, falls back to a full parse.
+     * The projection in the settings is ignored.
+     */
+    class IncrementalDocument : protected NormalParser {
+        public:
+            explicit IncrementalDocument(std::string text, const ParserSettings& settings=ParserSettings())
+                : NormalParser(without_projection(settings)), m_text(std::move(text)) {
+                reparse_all();
+            }
+
+            /*
+             * Replaces removed bytes at offset with inserted. Returns true if only the
+             * enclosing container was reparsed. Throws std::out_of_range for an edit
+             * outside the text.
+             */
+            bool apply_edit(size_t offset, size_t removed, const std::string& inserted);
+
+            const std::string& text() const { return m_text; }
+            const Value& value() const { return m_value; }
+            /* The error of the last full parse; no error after a successful local reparse */
+            const ErrorInfo& error_info() const { return m_error_info; }
+            const std::vector<SourceSpan>& spans() const { return m_source_spans; }
+
+        private:
+            static ParserSettings without_projection(ParserSettings settings) {
+                settings.projection = Projection();
+                return settings;
+            }
+
+            void reparse_all();
+            bool reparse_span(size_t span, size_t offset, size_t removed, const std::string& inserted);
+            size_t enclosing_span(size_t offset, size_t removed) const;
+            Value& value_of(size_t span);
+
+            std::string m_text;
+            Value m_value;
+            std::vector<SourceSpan> m_source_spans;
+    };
+
+    inline bool IncrementalDocument::apply_edit(size_t offset, size_t removed, const std::string& inserted) {
+        if(offset > m_text.size() || removed > m_text.size() - offset) {
+            throw std::out_of_range("Edit is outside the document");
+        }
+
+        size_t span = m_error_info.is_error() ? SourceSpan::npos : enclosing_span(offset, removed);
+        if(span != SourceSpan::npos && reparse_span(span, offset, removed, inserted)) {
+            return true;
+        }
+
+        if(span == SourceSpan::npos) {
+            m_text.replace(offset, removed, inserted);
+        }
+        reparse_all();
+        return false;
+    }
+
+    inline void IncrementalDocument::reparse_all() {
+        m_source_spans.clear();
+        m_spans = &m_source_spans;
+        init_parser_state(m_text.data(), m_text.data() + m_text.size());
+        m_value = parse_value();
+        if(m_value.type() == ValueType::Uninitialized) {
+            set_error(ErrorCode::eNoCorrespondingValue);
+        }
+        m_spans = nullptr;
+
+        if(m_error_info.is_error()) {
+            m_value = Value();
+            m_source_spans.clear();
+        }
+    }
+
+    /*
+     * The innermost span whose brackets lie outside the edited range, or npos.
+     * Members of an object with repeated names cannot be told apart by name, so
+     * such an object is returned instead of anything inside it.
+     */
+    inline size_t IncrementalDocument::enclosing_span(size_t offset, size_t removed) const {
+        /* Spans are sorted by begin, and every span around offset is an ancestor of the last one starting before it */
+        auto it = std::partition_point(m_source_spans.begin(), m_source_spans.end(),
+            [offset](const SourceSpan& s) { return s.begin < offset; });
+        if(it == m_source_spans.begin()) {
+            return SourceSpan::npos;
+        }
+
+        size_t span = it - m_source_spans.begin() - 1;
+        while(span != SourceSpan::npos && offset + removed >= m_source_spans[span].end) {
+            span = m_source_spans[span].parent;
+        }
+
+        for(size_t s = span; s != SourceSpan::npos; s = m_source_spans[s].parent) {
+            if(s != span && m_source_spans[s].duplicate_keys) {
+                span = s;
+            }
+        }
+        return span;
+    }
+
+    inline bool IncrementalDocument::reparse_span(size_t span, size_t offset, size_t removed, const std::string& inserted) {
+        const SourceSpan old = m_source_spans[span];
+        m_text.replace(offset, removed, inserted);
+
+        size_t begin = old.begin;
+        size_t end = old.end + inserted.size() - removed;
+
+        unsigned depth = 0;
+        for(size_t s = old.parent; s != SourceSpan::npos; s = m_source_spans[s].parent) {
+            ++depth;
+        }
+
+        std::vector<SourceSpan> spans;
+        m_spans = &spans;
+        init_parser_state(m_text.data() + begin, m_text.data() + end);
+        m_depth = depth;
+        /* No trailing whitespace skip: a line comment would otherwise stop at the region end instead of a newline */
+        Value value = *m_cur == '[' ? parse_array(Projection::all) : parse_object(Projection::all);
+        m_spans = nullptr;
+
+        /* The region must end exactly at the container's own closing bracket */
+        if(value.type() == ValueType::Uninitialized || m_error_info.is_error() || m_cur != m_end) {
+            return false;
+        }
+
+        /* The old subtree is the run of spans that start before the old closing bracket */
+        size_t subtree_end = std::partition_point(m_source_spans.begin() + span + 1, m_source_spans.end(),
+            [&old](const SourceSpan& s) { return s.begin < old.end; }) - m_source_spans.begin();
+        size_t shift = inserted.size() - removed;
+        size_t growth = spans.size() - (subtree_end - span);
+
+        for(SourceSpan& s : spans) {
+            s.begin += begin;
+            s.end += begin;
+            s.parent = s.parent == SourceSpan::npos ? old.parent : s.parent + span;
+        }
+        spans.front().index = old.index;
+        spans.front().key = old.key;
+
+        for(size_t s = old.parent; s != SourceSpan::npos; s = m_source_spans[s].parent) {
+            m_source_spans[s].end += shift;
+        }
+        /* Same-length edits that keep the number of containers leave the later spans alone */
+        if(shift != 0 || growth != 0) {
+            for(size_t s = subtree_end; s < m_source_spans.size(); ++s) {
+                SourceSpan& later = m_source_spans[s];
+                later.begin += shift;
+                later.end += shift;
+                if(later.parent != SourceSpan::npos && later.parent >= subtree_end) {
+                    later.parent += growth;
+                }
+            }
+        }
+
+        value_of(span) = std::move(value);
+
+        /* Offsets and parents are final, so the spans can be swapped in without reading them again */
+        if(spans.size() == subtree_end - span) {
+            std::move(spans.begin(), spans.end(), m_source_spans.begin() + span);
+        }
+        else {
+            m_source_spans.erase(m_source_spans.begin() + span, m_source_spans.begin() + subtree_end);
+            m_source_spans.insert(m_source_spans.begin() + span,
+                std::make_move_iterator(spans.begin()), std::make_move_iterator(spans.end()));
+        }
+
+        m_error_info = ErrorInfo{};
+        return true;
+    }
+
+    /* Walks down from the root by element index or member name */
+    inline Value& IncrementalDocument::value_of(size_t span) {
+        std::vector<size_t> path;
+        for(size_t s = span; m_source_spans[s].parent != SourceSpan::npos; s = m_source_spans[s].parent) {
+            path.push_back(s);
+        }
+
+        Value* value = &m_value;
+        for(auto it = path.rbegin(); it != path.rend(); ++it) {
+            const SourceSpan& s = m_source_spans[*it];
+            if(m_text[m_source_spans[s.parent].begin] == '[') {
+                value = &(*value)[s.index];
+            }
+            else {
+                value = &(*value)[s.key];
+            }
+        }
+        return *value;
+    }
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef SIMPLE_JSON_PARSER_MAPPEDFILE
 #define SIMPLE_JSON_PARSER_MAPPEDFILE
 
+#include <cstdint>
 #include <string>
 #include <fcntl.h>
 #include <unistd.h>
@@ -59,6 +60,24 @@ namespace SimpleJsonParser {
             return m_data;
         }
 
+        size_t size() const {
+            return m_size;
+        }
+
+        /* Drops the resident pages that lie entirely inside [begin, end). They are read again from the file if touched. */
+        void release(const char* begin, const char* end) const {
+            if(!is_open() || begin >= end) {
+                return;
+            }
+
+            const uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+            uintptr_t first = (reinterpret_cast<uintptr_t>(begin) + page_size - 1) & ~(page_size - 1);
+            uintptr_t last = reinterpret_cast<uintptr_t>(end) & ~(page_size - 1);
+            if(first < last) {
+                madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED);
+            }
+        }
+
     private:
         char* m_data;
         size_t m_size;
@@ -3,6 +3,7 @@
 
 #include "error.hpp"
 #include "document.hpp"
+#include "projection.hpp"
 #include <string>
 #include <limits>
 
@@ -13,26 +14,61 @@ namespace SimpleJsonParser {
         Value m_value;
     }; 
 
+    /* Where an array or object was found in the parsed text. Spans are recorded in pre-order. */
+    struct SourceSpan {
+        /* Offset of the opening bracket */
+        size_t begin;
+        /* One past the closing bracket */
+        size_t end;
+        /* Index of the enclosing span, npos for the outermost one */
+        size_t parent;
+        /* Position in the enclosing array */
+        size_t index;
+        /* Member name in the enclosing object */
+        std::string key;
+        /* A later member replaced an earlier one with the same name */
+        bool duplicate_keys;
+
+        static constexpr size_t npos = std::numeric_limits<size_t>::max();
+    };
+
      struct ParserSettings {
         bool allow_comments=true;
         int64_t max_integer_value=std::numeric_limits<int64_t>::max();
         int64_t min_integer_value=std::numeric_limits<int64_t>::min();
         double max_fraction_value=std::numeric_limits<double>::max();
-        double min_fraction_value=std::numeric_limits<double>::min();
+        double min_fraction_value=std::numeric_limits<double>::lowest();
         size_t max_string_length=std::numeric_limits<size_t>::max();
         size_t max_array_length=std::numeric_limits<size_t>::max();
         size_t max_num_members=std::numeric_limits<size_t>::max();
+        /* Nesting depth of objects and arrays */
         unsigned max_depth_object=100;
+        /* Members and elements outside the projection are validated and skipped instead of built */
+        Projection projection;
+
+        /* Whether any value or length limit is narrower than what the types can hold; the depth is not a limit here */
+        bool has_limits() const {
+            return max_integer_value != std::numeric_limits<int64_t>::max()
+                || min_integer_value != std::numeric_limits<int64_t>::min()
+                || max_fraction_value != std::numeric_limits<double>::max()
+                || min_fraction_value != std::numeric_limits<double>::lowest()
+                || max_string_length != std::numeric_limits<size_t>::max()
+                || max_array_length != std::numeric_limits<size_t>::max()
+                || max_num_members != std::numeric_limits<size_t>::max();
+        }
     };
 
     class ParserBase { 
         public:
             ParserBase() : m_settings() {}
             ParserBase(const ParserSettings& settings) : m_settings(settings) {}
+            virtual ~ParserBase() = default;
 
             virtual ParseResult parse(const std::string& json_str) { throw std::runtime_error("Not implemented"); }
             virtual ParseResult parse(const char* begin, const char* end) { throw std::runtime_error("Not implemented"); }
 
+            const ParserSettings& settings() const { return m_settings; }
+
         private:
             ParserSettings m_settings;
     };
@@ -4,30 +4,67 @@
 #include "error.hpp"
 #include "parser.hpp"
 #include "document.hpp"
+#include "simd.hpp"
+#include <algorithm>
 #include <cassert>
 #include <cctype>
 #include <cstdlib>
 #include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
 
 namespace SimpleJsonParser {
-   
-    class NormalParser : public ParserBase {
+
+    /*
+     * Parser policies decide at compile time which parts of ParserSettings are honored.
+     * allow_comments compiles in support for // and block comments, check_limits
+     * compiles in the length and range checks. The nesting depth is checked by every
+     * policy, since it guards the recursion. A runtime policy additionally reads
+     * allow_comments from the settings instead of assuming it.
+     */
+    struct RuntimePolicy {
+        static constexpr bool runtime = true;
+        static constexpr bool allow_comments = true;
+        static constexpr bool check_limits = true;
+    };
+
+    template<bool AllowComments, bool CheckLimits>
+    struct StaticPolicy {
+        static constexpr bool runtime = false;
+        static constexpr bool allow_comments = AllowComments;
+        static constexpr bool check_limits = CheckLimits;
+    };
+
+    template<typename Policy>
+    class BasicParser : public ParserBase {
         public:
-            NormalParser() : ParserBase() {}
-            NormalParser(const ParserSettings& settings) : ParserBase(settings) {}
+            BasicParser() : ParserBase() {}
+            BasicParser(const ParserSettings& settings) : ParserBase(settings) {}
 
             ParseResult parse(const std::string& json_str) override;
             ParseResult parse(const char* begin, const char* end) override;
 
-        private:
+        protected:
             void init_parser_state(const char* begin, const char* end);
-            Value parse_value();
-            Value parse_object();
-            Value parse_array();
+            void set_error(ErrorCode error_code);
+            void set_unexpected_error(ErrorCode error_code);
+            bool comments_enabled() const;
+            Value parse_value(size_t node=Projection::all);
+            Value parse_object(size_t node);
+            Value parse_array(size_t node);
             Value parse_string();
             Value parse_number();
             Value parse_special();
+            bool scan_number(bool& integral);
+            bool check_number(const char* start, bool integral, double val);
+            bool skip_projected(size_t node);
+            bool skip_value();
+            bool skip_object();
+            bool skip_array();
+            bool skip_string();
             void skip_whitespace();
+            bool skip_comment();
             bool is_whitespace(char c);
             bool consume_4hex(std::string& str);
             bool consume_digits();
@@ -35,51 +72,147 @@ namespace SimpleJsonParser {
             bool consume_exponent();
             char to_control(char c);
             bool consume_control_character(std::string& str);
-            
+            size_t open_span();
+            void close_span(size_t span);
+
+            const Kernels* m_kernels;
+            const char* m_begin;
             const char* m_cur;
             const char* m_end;
             size_t m_offset;
             unsigned m_line_number;
+            unsigned m_depth;
             ErrorInfo m_error_info;
+
+            /* Spans of the containers are recorded here when set */
+            std::vector<SourceSpan>* m_spans = nullptr;
+            size_t m_span_parent;
+            size_t m_span_index;
+            const std::string* m_span_key;
     };
 
-    void NormalParser::init_parser_state(const char* begin, const char* end) {
+    /* Honors every setting at run time */
+    using NormalParser = BasicParser<RuntimePolicy>;
+
+    template<typename Policy>
+    inline void BasicParser<Policy>::init_parser_state(const char* begin, const char* end) {
+        m_kernels = &kernels();
+        m_begin = begin;
         m_cur = begin;
-        m_end = m_end;
+        m_end = end;
         m_offset = 0;
         m_line_number = 1;
+        m_depth = 0;
         m_error_info = ErrorInfo{};
+        m_span_parent = SourceSpan::npos;
+        m_span_index = 0;
+        m_span_key = nullptr;
     }
 
-    ParseResult NormalParser::parse(const std::string& json) {
-        init_parser_state(json.c_str(), json.c_str() + json.size());
-        return ParseResult{m_error_info, parse_value()};
+    template<typename Policy>
+    inline ParseResult BasicParser<Policy>::parse(const std::string& json) {
+        return parse(json.c_str(), json.c_str() + json.size());
     }
 
-    ParseResult NormalParser::parse(const char* begin, const char* end) {
+    template<typename Policy>
+    inline ParseResult BasicParser<Policy>::parse(const char* begin, const char* end) {
         init_parser_state(begin, end);
-        return ParseResult{m_error_info, parse_value()};
+        Value value = parse_value(settings().projection.start());
+        if(value.type() == ValueType::Uninitialized) {
+            set_error(ErrorCode::eNoCorrespondingValue);
+        }
+        return ParseResult{m_error_info, std::move(value)};
+    }
+
+    /* Keeps the first error, which is the one closest to its cause */
+    template<typename Policy>
+    inline void BasicParser<Policy>::set_error(ErrorCode error_code) {
+        if(!m_error_info.is_error()) {
+            m_error_info = ErrorInfo(error_code, m_line_number, m_cur - m_begin);
+        }
+    }
+
+    /* Reports a comment where comments are disabled instead of the generic syntax error */
+    template<typename Policy>
+    inline void BasicParser<Policy>::set_unexpected_error(ErrorCode error_code) {
+        if(m_cur != m_end && *m_cur == '/' && !comments_enabled()) {
+            set_error(ErrorCode::eCommentIsDisallowed);
+        }
+        else {
+            set_error(error_code);
+        }
+    }
+
+    template<typename Policy>
+    inline bool BasicParser<Policy>::comments_enabled() const {
+        if constexpr (!Policy::allow_comments) {
+            return false;
+        }
+        else if constexpr (Policy::runtime) {
+            return settings().allow_comments;
+        }
+        else {
+            return true;
+        }
     }
 
-    
-    bool NormalParser::is_whitespace(char c) { 
+    template<typename Policy>
+    inline bool BasicParser<Policy>::is_whitespace(char c) {
         return c == '\x20' || c == '\x09' || c == '\x0A' || c == '\x0D';
     }
 
-    void NormalParser::skip_whitespace() {
-        while(m_cur != m_end && is_whitespace(*m_cur)) {
-            ++m_cur;
+    template<typename Policy>
+    inline void BasicParser<Policy>::skip_whitespace() {
+        /* Most runs are empty or a single space, which is not worth a call through the kernel table */
+        if(m_cur != m_end && is_whitespace(*m_cur)) {
+            m_cur = m_kernels->skip_whitespace(m_cur + 1, m_end);
+        }
+
+        if constexpr (Policy::allow_comments) {
+            while(m_cur != m_end && *m_cur == '/' && comments_enabled() && skip_comment()) {
+                m_cur = m_kernels->skip_whitespace(m_cur, m_end);
+            }
+        }
+    }
+
+    template<typename Policy>
+    inline bool BasicParser<Policy>::skip_comment() {
+        assert(*m_cur == '/');
+        if(m_cur + 1 == m_end) {
+            return false;
+        }
+
+        if(m_cur[1] == '/') {
+            m_cur += 2;
+            while(m_cur != m_end && *m_cur != '\n') {
+                ++m_cur;
+            }
+            return true;
+        }
+        else if(m_cur[1] == '*') {
+            const char* close = m_cur + 2;
+            while(close + 1 < m_end && !(close[0] == '*' && close[1] == '/')) {
+                ++close;
+            }
+            if(close + 1 >= m_end) {
+                return false;
+            }
+            m_cur = close + 2;
+            return true;
         }
+
+        return false;
     }
 
-    bool NormalParser::consume_4hex(std::string& str) {
+    template<typename Policy>
+    inline bool BasicParser<Policy>::consume_4hex(std::string& str) {
         assert(*m_cur == 'u');
         ++m_cur;
         if(m_cur + 3 >= m_end) {
             return false;
         }
 
-        if(isdigit(m_cur[0]) && isdigit(m_cur[1]) && isdigit(m_cur[2]) && isdigit(m_cur[3])) {
+        if(isxdigit(m_cur[0]) && isxdigit(m_cur[1]) && isxdigit(m_cur[2]) && isxdigit(m_cur[3])) {
             str += '\\';
             str += m_cur[0];
             str += m_cur[1];
@@ -92,7 +225,8 @@ namespace SimpleJsonParser {
         return false;
     }
 
-    char NormalParser::to_control(char c) {
+    template<typename Policy>
+    inline char BasicParser<Policy>::to_control(char c) {
         assert(*m_cur == 'b' || *m_cur == 'f' || *m_cur == 'n' || *m_cur == 'r' || *m_cur == 't');
         switch(*m_cur) {
             case 'b': return '\b';
@@ -105,12 +239,14 @@ namespace SimpleJsonParser {
         return '\0';
     }
 
-    bool NormalParser::consume_control_character(std::string& str) {
+    template<typename Policy>
+    inline bool BasicParser<Policy>::consume_control_character(std::string& str) {
         assert(*m_cur== '\\');
         ++m_cur;
 
         if(m_cur == m_end) {
-            return false;   
+            set_error(ErrorCode::eMissingControlCharacterAfterBackslash);
+            return false;
         }
 
         if(*m_cur == '"' || *m_cur == '\\' || *m_cur == '/') {
@@ -124,26 +260,45 @@ namespace SimpleJsonParser {
             return true;
         }
         else if(*m_cur == 'u') {
-            return consume_4hex(str);
+            if(!consume_4hex(str)) {
+                set_error(ErrorCode::eMissingHexDigitsAfterBackslashU);
+                return false;
+            }
+            return true;
         }
 
+        set_error(ErrorCode::eMissingControlCharacterAfterBackslash);
         return false;
     }
 
-    Value NormalParser::parse_string() {
+    template<typename Policy>
+    inline Value BasicParser<Policy>::parse_string() {
         std::string tmp;
         assert(*m_cur == '"');
         ++m_cur;
 
-        while(m_cur != m_end && *m_cur != '"') {
-            if(*m_cur == '\\') {
-                if(!consume_control_character(tmp)) {
-                    return Value();
-                }
+        while(true) {
+            const char* special = m_kernels->scan_string(m_cur, m_end);
+            tmp.append(m_cur, special);
+            m_cur = special;
+            if(m_cur == m_end || *m_cur == '"') {
+                break;
             }
-            else {
-                tmp += *m_cur;
-                ++m_cur;
+
+            if(!consume_control_character(tmp)) {
+                return Value();
+            }
+        }
+
+        if(m_cur == m_end) {
+            set_error(ErrorCode::eMissingDoubleQuote);
+            return Value();
+        }
+
+        if constexpr (Policy::check_limits) {
+            if(tmp.size() > settings().max_string_length) {
+                set_error(ErrorCode::eStringIsTooLong);
+                return Value();
             }
         }
 
@@ -151,7 +306,8 @@ namespace SimpleJsonParser {
         return Value(tmp);
     }
 
-    bool NormalParser::consume_positive_digits() {
+    template<typename Policy>
+    inline bool BasicParser<Policy>::consume_positive_digits() {
         if(m_cur == m_end || *m_cur == '0' || !isdigit(*m_cur)) {
             return false;
         }
@@ -164,7 +320,8 @@ namespace SimpleJsonParser {
         return true;
     }
 
-    bool NormalParser::consume_digits() {
+    template<typename Policy>
+    inline bool BasicParser<Policy>::consume_digits() {
         if(m_cur == m_end || !isdigit(*m_cur)) {
             return false;
         }
@@ -176,48 +333,112 @@ namespace SimpleJsonParser {
         return true;
     }
 
-    bool NormalParser::consume_exponent() {
+    template<typename Policy>
+    inline bool BasicParser<Policy>::consume_exponent() {
         assert(*m_cur == 'e' || *m_cur == 'E');
         ++m_cur;
         if(m_cur == m_end || (*m_cur != '+' && *m_cur != '-')) {
+            set_error(ErrorCode::eMissingPlusOrMinusAfterExponent);
             return false;
         }
         ++m_cur;
 
-        return consume_digits();
+        if(!consume_digits()) {
+            set_error(ErrorCode::eMissingDigitsAfterPlusOrMinus);
+            return false;
+        }
+        return true;
+    }
+
+    /*
+     * Integral literals are checked against the integer limits, everything else against the fraction limits.
+     * Literals outside the range of the type are clamped to it, so they only fail a bound narrower than the type.
+     */
+    template<typename Policy>
+    inline bool BasicParser<Policy>::check_number(const char* start, bool integral, double val) {
+        const ParserSettings& limits = settings();
+        if(integral) {
+            long long integer = std::strtoll(start, nullptr, 10);
+            if(integer > limits.max_integer_value) {
+                set_error(ErrorCode::eIntegerIsTooLarge);
+                return false;
+            }
+            if(integer < limits.min_integer_value) {
+                set_error(ErrorCode::eIntegerIsTooSmall);
+                return false;
+            }
+            return true;
+        }
+
+        /* strtod returns +-HUGE_VAL on overflow */
+        double clamped = std::min(std::max(val, std::numeric_limits<double>::lowest()), std::numeric_limits<double>::max());
+        if(clamped > limits.max_fraction_value) {
+            set_error(ErrorCode::eFractionIsTooLarge);
+            return false;
+        }
+        if(clamped < limits.min_fraction_value) {
+            set_error(ErrorCode::eFractionIsTooSmall);
+            return false;
+        }
+        return true;
     }
 
-    Value NormalParser::parse_number() {
+    template<typename Policy>
+    inline bool BasicParser<Policy>::scan_number(bool& integral) {
         assert(isdigit(*m_cur) || *m_cur == '-');
-        const char* start = m_cur;
+        integral = true;
 
         if(*m_cur == '-') {
             ++m_cur;
-            if(!consume_positive_digits())
-                return Value();
         }
-        else if(*m_cur == '0') {
+
+        if(m_cur != m_end && *m_cur == '0') {
             ++m_cur;
         }
-        else {
-            consume_positive_digits();
+        else if(!consume_positive_digits()) {
+            set_error(ErrorCode::eMissingDigitsAfterMinus);
+            return false;
         }
-    
+
         if(m_cur != m_end && *m_cur == '.') {
             ++m_cur;
-            if(!consume_digits())
-                return Value();
+            integral = false;
+            if(!consume_digits()) {
+                set_error(ErrorCode::eMissingDigitsAfterDot);
+                return false;
+            }
         }
 
         if(m_cur != m_end && (*m_cur == 'e' || *m_cur == 'E')) {
+            integral = false;
             if(!consume_exponent())
+                return false;
+        }
+
+        return true;
+    }
+
+    template<typename Policy>
+    inline Value BasicParser<Policy>::parse_number() {
+        const char* start = m_cur;
+        bool integral;
+        if(!scan_number(integral)) {
+            return Value();
+        }
+
+        double val = std::strtod(start, nullptr);
+
+        if constexpr (Policy::check_limits) {
+            if(!check_number(start, integral, val)) {
                 return Value();
+            }
         }
 
-        return Value(std::strtod(start, nullptr));
+        return Value(val);
     }
 
-    Value NormalParser::parse_special() {
+    template<typename Policy>
+    inline Value BasicParser<Policy>::parse_special() {
         assert(*m_cur == 't' || *m_cur == 'f' || *m_cur == 'n');
         if(m_cur + 3 < m_end && !std::memcmp(m_cur, "true", 4)) {
             m_cur += 4;
@@ -232,25 +453,65 @@ namespace SimpleJsonParser {
             return Value(ValueType::Null);
         }
 
+        set_error(ErrorCode::eNoCorrespondingValue);
         return Value();
     }
 
-    Value NormalParser::parse_array() {
+    template<typename Policy>
+    inline Value BasicParser<Policy>::parse_array(size_t node) {
         assert(*m_cur == '[');
+        size_t span = open_span();
         ++m_cur;
 
+        if(++m_depth > settings().max_depth_object) {
+            set_error(ErrorCode::eObjectDepthLimitExceed);
+            return Value();
+        }
+
         Value arr{ValueType::Array};
+        size_t length = 0;
 
         skip_whitespace();
 
-        if(m_cur == m_end || *m_cur == ']') {
+        if(m_cur == m_end) {
+            set_error(ErrorCode::eMissingCommaOrSquareBracket);
+            return Value();
+        }
+        if(*m_cur == ']') {
             ++m_cur;
+            --m_depth;
+            close_span(span);
             return arr;
         }
 
         while(m_cur != m_end) {
-            Value val = parse_value();
-            arr.push_back(std::move(val));
+            if constexpr (Policy::check_limits) {
+                if(length == settings().max_array_length) {
+                    set_error(ErrorCode::eArrayIsTooLong);
+                    return Value();
+                }
+            }
+
+            size_t child = node == Projection::all ? Projection::all : settings().projection.element(node, length);
+            ++length;
+
+            if(skip_projected(child)) {
+                if(!skip_value()) {
+                    return Value();
+                }
+            }
+            else {
+                if(m_spans != nullptr) {
+                    m_span_index = length - 1;
+                    m_span_key = nullptr;
+                }
+                Value val = parse_value(child);
+                if(val.type() == ValueType::Uninitialized) {
+                    return Value();
+                }
+                arr.push_back(std::move(val));
+            }
+
             if(m_cur == m_end || *m_cur != ',') {
                 break;
             }
@@ -258,44 +519,91 @@ namespace SimpleJsonParser {
         }
 
         if(m_cur == m_end || *m_cur != ']') {
+            set_unexpected_error(ErrorCode::eMissingCommaOrSquareBracket);
             return Value();
         }
         ++m_cur;
+
+        --m_depth;
+        close_span(span);
         return arr;
     }
 
-    Value NormalParser::parse_object() {
+    template<typename Policy>
+    inline Value BasicParser<Policy>::parse_object(size_t node) {
         assert(*m_cur == '{');
+        size_t span = open_span();
         ++m_cur;
 
+        if(++m_depth > settings().max_depth_object) {
+            set_error(ErrorCode::eObjectDepthLimitExceed);
+            return Value();
+        }
+
         Value obj{ValueType::Object};
+        size_t num_members = 0;
 
         skip_whitespace();
         if(m_cur != m_end && *m_cur == '}') {
             ++m_cur;
+            --m_depth;
+            close_span(span);
             return obj;
         }
 
         while(m_cur != m_end) {
             skip_whitespace();
+            if(m_cur == m_end || *m_cur != '"') {
+                set_unexpected_error(ErrorCode::eMissingDoubleQuote);
+                return Value();
+            }
             Value key = parse_string();
             if(key.type() == ValueType::Uninitialized) {
                 return Value();
             }
 
-            skip_whitespace();  
+            skip_whitespace();
 
             if(m_cur == m_end || *m_cur != ':') {
+                set_unexpected_error(ErrorCode::eMissingColon);
                 return Value();
             }
             ++m_cur;
 
-            Value val = parse_value();
-            if(val.type() == ValueType::Uninitialized) {
-                return Value();
+            if constexpr (Policy::check_limits) {
+                if(++num_members > settings().max_num_members) {
+                    set_error(ErrorCode::eObjectHasTooManyMembers);
+                    return Value();
+                }
             }
 
-            obj.add_member(key.string(), std::move(val));
+            size_t child = node == Projection::all ? Projection::all : settings().projection.member(node, key.string());
+
+            if(skip_projected(child)) {
+                if(!skip_value()) {
+                    return Value();
+                }
+            }
+            else if(m_spans != nullptr) {
+                m_span_key = &key.string();
+                m_span_index = 0;
+                Value val = parse_value(child);
+                if(val.type() == ValueType::Uninitialized) {
+                    return Value();
+                }
+                size_t size = obj.size_object();
+                obj.add_member(key.string(), std::move(val));
+                if(obj.size_object() == size) {
+                    (*m_spans)[span].duplicate_keys = true;
+                }
+            }
+            else {
+                Value val = parse_value(child);
+                if(val.type() == ValueType::Uninitialized) {
+                    return Value();
+                }
+                obj.add_member(key.string(), std::move(val));
+            }
 
             if(m_cur == m_end || *m_cur != ',') {
                 break;
@@ -304,14 +612,19 @@ namespace SimpleJsonParser {
             ++m_cur;
         }
 
-        if(m_cur == m_end || *m_cur != '}')
+        if(m_cur == m_end || *m_cur != '}') {
+            set_unexpected_error(ErrorCode::eMissingCommaOrCurlyBracked);
             return Value();
-
+        }
         ++m_cur;
+
+        --m_depth;
+        close_span(span);
         return obj;
     }
 
-    Value NormalParser::parse_value() {
+    template<typename Policy>
+    inline Value BasicParser<Policy>::parse_value(size_t node) {
         Value v{};
 
         skip_whitespace();
@@ -321,10 +634,10 @@ namespace SimpleJsonParser {
         }
 
         if(*m_cur == '{') {
-            v = parse_object();
+            v = parse_object(node);
         }
         else if(*m_cur == '[') {
-            v = parse_array();
+            v = parse_array(node);
         }
         else if(*m_cur == '"') {
             v = parse_string();
@@ -335,11 +648,235 @@ namespace SimpleJsonParser {
         else if(*m_cur == 'n' || *m_cur == 't' || *m_cur == 'f') {
             v = parse_special();
         }
+        else {
+            set_unexpected_error(ErrorCode::eNoCorrespondingValue);
+        }
 
         skip_whitespace();
 
         return v;
     }
 
+    /* Starts the span of the container at m_cur when spans are recorded */
+    template<typename Policy>
+    inline size_t BasicParser<Policy>::open_span() {
+        if(m_spans == nullptr) {
+            return SourceSpan::npos;
+        }
+
+        size_t span = m_spans->size();
+        m_spans->push_back(SourceSpan{static_cast<size_t>(m_cur - m_begin), SourceSpan::npos, m_span_parent,
+            m_span_index, m_span_key != nullptr ? *m_span_key : std::string(), false});
+        m_span_parent = span;
+        return span;
+    }
+
+    template<typename Policy>
+    inline void BasicParser<Policy>::close_span(size_t span) {
+        if(m_spans == nullptr) {
+            return;
+        }
+
+        SourceSpan& source = (*m_spans)[span];
+        source.end = m_cur - m_begin;
+        m_span_parent = source.parent;
+    }
+
+    /*
+     * Whether the value ahead is outside the projection: either nothing below the node
+     * is selected, or the node only selects members of a container and the value is not one.
+     */
+    template<typename Policy>
+    inline bool BasicParser<Policy>::skip_projected(size_t node) {
+        if(node == Projection::all) {
+            return false;
+        }
+        if(node == Projection::none) {
+            return true;
+        }
+
+        skip_whitespace();
+        return m_cur == m_end || (*m_cur != '{' && *m_cur != '[');
+    }
+
+    /* Validates a value without building it or allocating */
+    template<typename Policy>
+    inline bool BasicParser<Policy>::skip_value() {
+        skip_whitespace();
+
+        if(m_cur == m_end) {
+            set_error(ErrorCode::eNoCorrespondingValue);
+            return false;
+        }
+
+        bool valid = false;
+        bool integral;
+        if(*m_cur == '{') {
+            valid = skip_object();
+        }
+        else if(*m_cur == '[') {
+            valid = skip_array();
+        }
+        else if(*m_cur == '"') {
+            valid = skip_string();
+        }
+        else if(isdigit(*m_cur) || *m_cur == '-') {
+            valid = scan_number(integral);
+        }
+        else if(*m_cur == 'n' || *m_cur == 't' || *m_cur == 'f') {
+            valid = parse_special().type() != ValueType::Uninitialized;
+        }
+        else {
+            set_unexpected_error(ErrorCode::eNoCorrespondingValue);
+        }
+
+        skip_whitespace();
+
+        return valid;
+    }
+
+    template<typename Policy>
+    inline bool BasicParser<Policy>::skip_string() {
+        assert(*m_cur == '"');
+        ++m_cur;
+
+        while(true) {
+            m_cur = m_kernels->scan_string(m_cur, m_end);
+            if(m_cur == m_end) {
+                set_error(ErrorCode::eMissingDoubleQuote);
+                return false;
+            }
+            if(*m_cur == '"') {
+                ++m_cur;
+                return true;
+            }
+
+            ++m_cur;
+            if(m_cur == m_end) {
+                set_error(ErrorCode::eMissingControlCharacterAfterBackslash);
+                return false;
+            }
+
+            char c = *m_cur;
+            if(c == '"' || c == '\\' || c == '/' || c == 'b' || c == 'f' || c == 'n' || c == 'r' || c == 't') {
+                ++m_cur;
+            }
+            else if(c == 'u') {
+                if(m_cur + 4 >= m_end || !isxdigit(m_cur[1]) || !isxdigit(m_cur[2]) || !isxdigit(m_cur[3]) || !isxdigit(m_cur[4])) {
+                    set_error(ErrorCode::eMissingHexDigitsAfterBackslashU);
+                    return false;
+                }
+                m_cur += 5;
+            }
+            else {
+                set_error(ErrorCode::eMissingControlCharacterAfterBackslash);
+                return false;
+            }
+        }
+    }
+
+    template<typename Policy>
+    inline bool BasicParser<Policy>::skip_array() {
+        assert(*m_cur == '[');
+        ++m_cur;
+
+        if(++m_depth > settings().max_depth_object) {
+            set_error(ErrorCode::eObjectDepthLimitExceed);
+            return false;
+        }
+
+        skip_whitespace();
+        if(m_cur == m_end) {
+            set_error(ErrorCode::eMissingCommaOrSquareBracket);
+            return false;
+        }
+
+        if(*m_cur != ']') {
+            while(true) {
+                if(!skip_value()) {
+                    return false;
+                }
+                if(m_cur == m_end || *m_cur != ',') {
+                    break;
+                }
+                ++m_cur;
+            }
+
+            if(m_cur == m_end || *m_cur != ']') {
+                set_unexpected_error(ErrorCode::eMissingCommaOrSquareBracket);
+                return false;
+            }
+        }
+        ++m_cur;
+
+        --m_depth;
+        return true;
+    }
+
+    template<typename Policy>
+    inline bool BasicParser<Policy>::skip_object() {
+        assert(*m_cur == '{');
+        ++m_cur;
+
+        if(++m_depth > settings().max_depth_object) {
+            set_error(ErrorCode::eObjectDepthLimitExceed);
+            return false;
+        }
+
+        skip_whitespace();
+        if(m_cur == m_end || *m_cur != '}') {
+            while(true) {
+                skip_whitespace();
+                if(m_cur == m_end || *m_cur != '"') {
+                    set_unexpected_error(ErrorCode::eMissingDoubleQuote);
+                    return false;
+                }
+                if(!skip_string()) {
+                    return false;
+                }
+
+                skip_whitespace();
+                if(m_cur == m_end || *m_cur != ':') {
+                    set_unexpected_error(ErrorCode::eMissingColon);
+                    return false;
+                }
+                ++m_cur;
+
+                if(!skip_value()) {
+                    return false;
+                }
+                if(m_cur == m_end || *m_cur != ',') {
+                    break;
+                }
+                ++m_cur;
+            }
+
+            if(m_cur == m_end || *m_cur != '}') {
+                set_unexpected_error(ErrorCode::eMissingCommaOrCurlyBracked);
+                return false;
+            }
+        }
+        ++m_cur;
+
+        --m_depth;
+        return true;
+    }
+
+    /*
+     * Picks the cheapest prebuilt instantiation for the given settings: limit checks
+     * are compiled in only when at least one limit is narrower than the type allows.
+     */
+    inline std::unique_ptr<ParserBase> make_parser(const ParserSettings& settings=ParserSettings{}) {
+        if(settings.allow_comments) {
+            if(settings.has_limits())
+                return std::make_unique<BasicParser<StaticPolicy<true, true>>>(settings);
+            return std::make_unique<BasicParser<StaticPolicy<true, false>>>(settings);
+        }
+
+        if(settings.has_limits())
+            return std::make_unique<BasicParser<StaticPolicy<false, true>>>(settings);
+        return std::make_unique<BasicParser<StaticPolicy<false, false>>>(settings);
+    }
+
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,215 @@
+#ifndef SIMPLE_JSON_PARSER_PROJECTION
+#define SIMPLE_JSON_PARSER_PROJECTION
+
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace SimpleJsonParser {
+
+    /*
+     * A set of JSON Pointers (RFC 6901) compiled into a trie. The parser only builds
+     * values on the selected paths and skips everything else. A "*" token matches
+     * every element of an array and every member of an object; a member or element
+     * that is also named explicitly gets the union of both selections. Arrays on a selected
+     * path keep only their matching elements, so element indices are not preserved.
+     * An empty projection selects the whole document.
+     */
+    class Projection {
+        public:
+            /* The node selects its whole subtree */
+            static constexpr size_t all = std::numeric_limits<size_t>::max();
+            /* Nothing below the node is selected */
+            static constexpr size_t none = std::numeric_limits<size_t>::max() - 1;
+            static constexpr size_t root = 0;
+
+            Projection() = default;
+
+            /* Throws std::invalid_argument for a pointer that is neither empty nor starts with '/' */
+            static Projection compile(const std::vector<std::string>& pointers) {
+                Projection projection;
+                if(pointers.empty())
+                    return projection;
+
+                projection.m_nodes.emplace_back();
+                for(const std::string& pointer : pointers) {
+                    projection.add(pointer);
+                }
+                projection.merge_wildcards(root);
+                return projection;
+            }
+
+            bool empty() const { return m_nodes.empty(); }
+
+            /* Where parsing starts: all for an empty projection or one containing "" */
+            size_t start() const {
+                return empty() || m_nodes[root].selected ? all : root;
+            }
+
+            size_t member(size_t node, const std::string& key) const {
+                const Node& n = m_nodes[node];
+                auto it = n.members.find(key);
+                if(it != n.members.end())
+                    return resolve(it->second);
+                return resolve(n.wildcard);
+            }
+
+            size_t element(size_t node, size_t index) const {
+                const Node& n = m_nodes[node];
+                if(!n.elements.empty()) {
+                    auto it = n.elements.find(index);
+                    if(it != n.elements.end())
+                        return resolve(it->second);
+                }
+                return resolve(n.wildcard);
+            }
+
+        private:
+            /* Tokens that are array indices also live in elements, keyed numerically, pointing at the same node */
+            struct Node {
+                std::map<std::string, size_t> members;
+                std::map<size_t, size_t> elements;
+                size_t wildcard = none;
+                bool selected = false;
+            };
+
+            size_t resolve(size_t node) const {
+                if(node == none)
+                    return none;
+                return m_nodes[node].selected ? all : node;
+            }
+
+            size_t child(size_t node, const std::string& token) {
+                size_t next;
+                if(token == "*") {
+                    next = m_nodes[node].wildcard;
+                    if(next == none) {
+                        next = m_nodes.size();
+                        m_nodes[node].wildcard = next;
+                        m_nodes.emplace_back();
+                    }
+                    return next;
+                }
+
+                auto it = m_nodes[node].members.find(token);
+                if(it != m_nodes[node].members.end())
+                    return it->second;
+                next = m_nodes.size();
+                m_nodes[node].members.emplace(token, next);
+                size_t index;
+                if(parse_index(token, index))
+                    m_nodes[node].elements.emplace(index, next);
+                m_nodes.emplace_back();
+                return next;
+            }
+
+            /* RFC 6901 array index: "0" or digits without a leading zero */
+            static bool parse_index(const std::string& token, size_t& index) {
+                if(token.empty() || token.size() > 18 || (token[0] == '0' && token.size() > 1))
+                    return false;
+                index = 0;
+                for(char c : token) {
+                    if(c < '0' || c > '9')
+                        return false;
+                    index = index * 10 + (c - '0');
+                }
+                return true;
+            }
+
+            /* Top-down, so that a merged-in wildcard is merged further into the children it reaches */
+            void merge_wildcards(size_t node) {
+                size_t wildcard = m_nodes[node].wildcard;
+                if(wildcard != none) {
+                    for(size_t child : explicit_children(node))
+                        merge(child, wildcard);
+                }
+
+                for(size_t child : explicit_children(node))
+                    merge_wildcards(child);
+                if(wildcard != none)
+                    merge_wildcards(wildcard);
+            }
+
+            /* Every element entry shares its node with a member entry */
+            std::vector<size_t> explicit_children(size_t node) const {
+                std::vector<size_t> children;
+                for(const auto& member : m_nodes[node].members)
+                    children.push_back(member.second);
+                return children;
+            }
+
+            /* Adds everything selected below src to dst; src is left untouched */
+            void merge(size_t dst, size_t src) {
+                /* Copies, because cloning may reallocate m_nodes */
+                const Node from = m_nodes[src];
+                m_nodes[dst].selected = m_nodes[dst].selected || from.selected;
+
+                for(const auto& member : from.members) {
+                    auto it = m_nodes[dst].members.find(member.first);
+                    if(it != m_nodes[dst].members.end()) {
+                        merge(it->second, member.second);
+                        continue;
+                    }
+                    size_t copy = clone(member.second);
+                    m_nodes[dst].members.emplace(member.first, copy);
+                    size_t index;
+                    if(parse_index(member.first, index))
+                        m_nodes[dst].elements.emplace(index, copy);
+                }
+
+                if(from.wildcard != none) {
+                    if(m_nodes[dst].wildcard != none) {
+                        merge(m_nodes[dst].wildcard, from.wildcard);
+                    }
+                    else {
+                        size_t copy = clone(from.wildcard);
+                        m_nodes[dst].wildcard = copy;
+                    }
+                }
+            }
+
+            size_t clone(size_t src) {
+                size_t copy = m_nodes.size();
+                m_nodes.emplace_back();
+                merge(copy, src);
+                return copy;
+            }
+
+            void add(const std::string& pointer) {
+                if(!pointer.empty() && pointer[0] != '/')
+                    throw std::invalid_argument("Invalid JSON pointer: " + pointer);
+
+                size_t node = root;
+                size_t pos = 0;
+                while(pos < pointer.size()) {
+                    size_t next = pointer.find('/', pos + 1);
+                    if(next == std::string::npos)
+                        next = pointer.size();
+                    node = child(node, unescape(pointer.substr(pos + 1, next - pos - 1)));
+                    pos = next;
+                }
+                m_nodes[node].selected = true;
+            }
+
+            static std::string unescape(const std::string& token) {
+                std::string out;
+                for(size_t i = 0; i < token.size(); ++i) {
+                    if(token[i] == '~' && i + 1 < token.size() && (token[i + 1] == '0' || token[i + 1] == '1')) {
+                        out += token[i + 1] == '0' ? '~' : '/';
+                        ++i;
+                    }
+                    else {
+                        out += token[i];
+                    }
+                }
+                return out;
+            }
+
+            std::vector<Node> m_nodes;
+    };
+}
+
+#endif
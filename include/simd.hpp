@@ -0,0 +1,454 @@
+#ifndef SIMPLE_JSON_PARSER_SIMD
+#define SIMPLE_JSON_PARSER_SIMD
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMPLE_JSON_PARSER_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace SimpleJsonParser {
+
+    enum class SimdLevel {
+        Scalar = 0,
+        SSE42 = 1,
+        AVX2 = 2,
+        AVX512 = 3,
+    };
+
+    /* One implementation of every scanning kernel, all bound to the same instruction set */
+    struct Kernels {
+        SimdLevel level;
+
+        /* First character in [cur, end) that is not JSON whitespace, or end */
+        const char* (*skip_whitespace)(const char* cur, const char* end);
+
+        /* First '"' or '\\' in [cur, end), or end */
+        const char* (*scan_string)(const char* cur, const char* end);
+
+        /*
+         * Writes the offsets of every {}[]:," in [begin, end) to out and returns how many
+         * were found. Characters inside strings are not masked. out must have room for
+         * end - begin entries.
+         */
+        size_t (*structural_index)(const char* begin, const char* end, uint32_t* out);
+
+        /* Whether [begin, end) is well-formed UTF-8 (no overlongs, surrogates or code points above U+10FFFF) */
+        bool (*validate_utf8)(const char* begin, const char* end);
+    };
+
+    namespace detail {
+        inline bool is_json_whitespace(char c) {
+            return c == '\x20' || c == '\x09' || c == '\x0A' || c == '\x0D';
+        }
+
+        inline bool is_structural(char c) {
+            return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',' || c == '"';
+        }
+
+        /* Returns the end of the code point starting at p, or nullptr if it is malformed */
+        inline const unsigned char* next_utf8_char(const unsigned char* p, const unsigned char* end) {
+            unsigned char c = p[0];
+            if(c < 0x80) {
+                return p + 1;
+            }
+            if(c < 0xC2) {
+                return nullptr;
+            }
+
+            auto continuation = [](unsigned char b) { return (b & 0xC0) == 0x80; };
+
+            if(c < 0xE0) {
+                if(end - p < 2 || !continuation(p[1]))
+                    return nullptr;
+                return p + 2;
+            }
+            if(c < 0xF0) {
+                if(end - p < 3 || !continuation(p[2]))
+                    return nullptr;
+                unsigned char low = c == 0xE0 ? 0xA0 : 0x80;
+                unsigned char high = c == 0xED ? 0x9F : 0xBF;
+                if(p[1] < low || p[1] > high)
+                    return nullptr;
+                return p + 3;
+            }
+            if(c < 0xF5) {
+                if(end - p < 4 || !continuation(p[2]) || !continuation(p[3]))
+                    return nullptr;
+                unsigned char low = c == 0xF0 ? 0x90 : 0x80;
+                unsigned char high = c == 0xF4 ? 0x8F : 0xBF;
+                if(p[1] < low || p[1] > high)
+                    return nullptr;
+                return p + 4;
+            }
+
+            return nullptr;
+        }
+
+        /* Scalar kernels, the reference every other level has to match */
+        inline const char* skip_whitespace_scalar(const char* cur, const char* end) {
+            while(cur != end && is_json_whitespace(*cur)) {
+                ++cur;
+            }
+            return cur;
+        }
+
+        inline const char* scan_string_scalar(const char* cur, const char* end) {
+            while(cur != end && *cur != '"' && *cur != '\\') {
+                ++cur;
+            }
+            return cur;
+        }
+
+        inline size_t structural_index_scalar(const char* begin, const char* end, uint32_t* out) {
+            size_t count = 0;
+            for(const char* cur = begin; cur != end; ++cur) {
+                if(is_structural(*cur)) {
+                    out[count++] = static_cast<uint32_t>(cur - begin);
+                }
+            }
+            return count;
+        }
+
+        inline bool validate_utf8_scalar(const char* begin, const char* end) {
+            const unsigned char* cur = reinterpret_cast<const unsigned char*>(begin);
+            const unsigned char* last = reinterpret_cast<const unsigned char*>(end);
+            while(cur != last) {
+                cur = next_utf8_char(cur, last);
+                if(cur == nullptr)
+                    return false;
+            }
+            return true;
+        }
+
+        inline size_t append_offsets(uint64_t mask, uint32_t base, uint32_t* out) {
+            size_t count = 0;
+            while(mask != 0) {
+                out[count++] = base + static_cast<uint32_t>(__builtin_ctzll(mask));
+                mask &= mask - 1;
+            }
+            return count;
+        }
+
+#ifdef SIMPLE_JSON_PARSER_X86_DISPATCH
+        /* SSE4.2: string compare instructions against small character sets */
+        __attribute__((target("sse4.2")))
+        inline const char* skip_whitespace_sse42(const char* cur, const char* end) {
+            const __m128i set = _mm_setr_epi8(' ', '\t', '\n', '\r', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+            while(end - cur >= 16) {
+                __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+                int index = _mm_cmpestri(set, 4, data, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_NEGATIVE_POLARITY);
+                if(index != 16)
+                    return cur + index;
+                cur += 16;
+            }
+            return skip_whitespace_scalar(cur, end);
+        }
+
+        __attribute__((target("sse4.2")))
+        inline const char* scan_string_sse42(const char* cur, const char* end) {
+            const __m128i set = _mm_setr_epi8('"', '\\', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+            while(end - cur >= 16) {
+                __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+                int index = _mm_cmpestri(set, 2, data, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY);
+                if(index != 16)
+                    return cur + index;
+                cur += 16;
+            }
+            return scan_string_scalar(cur, end);
+        }
+
+        __attribute__((target("sse4.2")))
+        inline size_t structural_index_sse42(const char* begin, const char* end, uint32_t* out) {
+            const __m128i set = _mm_setr_epi8('{', '}', '[', ']', ':', ',', '"', 0, 0, 0, 0, 0, 0, 0, 0, 0);
+            const char* cur = begin;
+            size_t count = 0;
+            while(end - cur >= 16) {
+                __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+                __m128i bits = _mm_cmpestrm(set, 7, data, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK);
+                uint64_t mask = static_cast<uint32_t>(_mm_cvtsi128_si32(bits)) & 0xFFFF;
+                count += append_offsets(mask, static_cast<uint32_t>(cur - begin), out + count);
+                cur += 16;
+            }
+            size_t tail = structural_index_scalar(cur, end, out + count);
+            for(size_t i = count; i < count + tail; ++i) {
+                out[i] += static_cast<uint32_t>(cur - begin);
+            }
+            return count + tail;
+        }
+
+        __attribute__((target("sse4.2")))
+        inline bool validate_utf8_sse42(const char* begin, const char* end) {
+            const unsigned char* cur = reinterpret_cast<const unsigned char*>(begin);
+            const unsigned char* last = reinterpret_cast<const unsigned char*>(end);
+            while(cur != last) {
+                if(last - cur >= 16) {
+                    __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+                    if(_mm_movemask_epi8(data) == 0) {
+                        cur += 16;
+                        continue;
+                    }
+                }
+                cur = next_utf8_char(cur, last);
+                if(cur == nullptr)
+                    return false;
+            }
+            return true;
+        }
+
+        /* AVX2: byte compares on 32-byte blocks */
+        __attribute__((target("avx2")))
+        inline const char* skip_whitespace_avx2(const char* cur, const char* end) {
+            const __m256i space = _mm256_set1_epi8(' ');
+            const __m256i tab = _mm256_set1_epi8('\t');
+            const __m256i newline = _mm256_set1_epi8('\n');
+            const __m256i carriage = _mm256_set1_epi8('\r');
+            while(end - cur >= 32) {
+                __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur));
+                __m256i ws = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(data, space), _mm256_cmpeq_epi8(data, tab)),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(data, newline), _mm256_cmpeq_epi8(data, carriage)));
+                uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(ws));
+                if(mask != 0)
+                    return cur + __builtin_ctz(mask);
+                cur += 32;
+            }
+            return skip_whitespace_scalar(cur, end);
+        }
+
+        __attribute__((target("avx2")))
+        inline const char* scan_string_avx2(const char* cur, const char* end) {
+            const __m256i quote = _mm256_set1_epi8('"');
+            const __m256i backslash = _mm256_set1_epi8('\\');
+            while(end - cur >= 32) {
+                __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur));
+                __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(data, quote), _mm256_cmpeq_epi8(data, backslash));
+                uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+                if(mask != 0)
+                    return cur + __builtin_ctz(mask);
+                cur += 32;
+            }
+            return scan_string_scalar(cur, end);
+        }
+
+        __attribute__((target("avx2")))
+        inline size_t structural_index_avx2(const char* begin, const char* end, uint32_t* out) {
+            const char* cur = begin;
+            size_t count = 0;
+            while(end - cur >= 32) {
+                __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur));
+                __m256i hit = _mm256_or_si256(
+                    _mm256_or_si256(
+                        _mm256_or_si256(_mm256_cmpeq_epi8(data, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(data, _mm256_set1_epi8('}'))),
+                        _mm256_or_si256(_mm256_cmpeq_epi8(data, _mm256_set1_epi8('[')), _mm256_cmpeq_epi8(data, _mm256_set1_epi8(']')))),
+                    _mm256_or_si256(
+                        _mm256_or_si256(_mm256_cmpeq_epi8(data, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(data, _mm256_set1_epi8(','))),
+                        _mm256_cmpeq_epi8(data, _mm256_set1_epi8('"'))));
+                uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+                count += append_offsets(mask, static_cast<uint32_t>(cur - begin), out + count);
+                cur += 32;
+            }
+            size_t tail = structural_index_scalar(cur, end, out + count);
+            for(size_t i = count; i < count + tail; ++i) {
+                out[i] += static_cast<uint32_t>(cur - begin);
+            }
+            return count + tail;
+        }
+
+        __attribute__((target("avx2")))
+        inline bool validate_utf8_avx2(const char* begin, const char* end) {
+            const unsigned char* cur = reinterpret_cast<const unsigned char*>(begin);
+            const unsigned char* last = reinterpret_cast<const unsigned char*>(end);
+            while(cur != last) {
+                if(last - cur >= 32) {
+                    __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur));
+                    if(_mm256_movemask_epi8(data) == 0) {
+                        cur += 32;
+                        continue;
+                    }
+                }
+                cur = next_utf8_char(cur, last);
+                if(cur == nullptr)
+                    return false;
+            }
+            return true;
+        }
+
+        /* AVX-512BW: compares straight into 64-bit masks */
+        __attribute__((target("avx512f,avx512bw")))
+        inline const char* skip_whitespace_avx512(const char* cur, const char* end) {
+            const __m512i space = _mm512_set1_epi8(' ');
+            const __m512i tab = _mm512_set1_epi8('\t');
+            const __m512i newline = _mm512_set1_epi8('\n');
+            const __m512i carriage = _mm512_set1_epi8('\r');
+            while(end - cur >= 64) {
+                __m512i data = _mm512_loadu_si512(reinterpret_cast<const void*>(cur));
+                uint64_t ws = _mm512_cmpeq_epi8_mask(data, space) | _mm512_cmpeq_epi8_mask(data, tab)
+                    | _mm512_cmpeq_epi8_mask(data, newline) | _mm512_cmpeq_epi8_mask(data, carriage);
+                if(~ws != 0)
+                    return cur + __builtin_ctzll(~ws);
+                cur += 64;
+            }
+            return skip_whitespace_scalar(cur, end);
+        }
+
+        __attribute__((target("avx512f,avx512bw")))
+        inline const char* scan_string_avx512(const char* cur, const char* end) {
+            const __m512i quote = _mm512_set1_epi8('"');
+            const __m512i backslash = _mm512_set1_epi8('\\');
+            while(end - cur >= 64) {
+                __m512i data = _mm512_loadu_si512(reinterpret_cast<const void*>(cur));
+                uint64_t hit = _mm512_cmpeq_epi8_mask(data, quote) | _mm512_cmpeq_epi8_mask(data, backslash);
+                if(hit != 0)
+                    return cur + __builtin_ctzll(hit);
+                cur += 64;
+            }
+            return scan_string_scalar(cur, end);
+        }
+
+        __attribute__((target("avx512f,avx512bw")))
+        inline size_t structural_index_avx512(const char* begin, const char* end, uint32_t* out) {
+            const char* cur = begin;
+            size_t count = 0;
+            while(end - cur >= 64) {
+                __m512i data = _mm512_loadu_si512(reinterpret_cast<const void*>(cur));
+                uint64_t mask = _mm512_cmpeq_epi8_mask(data, _mm512_set1_epi8('{'))
+                    | _mm512_cmpeq_epi8_mask(data, _mm512_set1_epi8('}'))
+                    | _mm512_cmpeq_epi8_mask(data, _mm512_set1_epi8('['))
+                    | _mm512_cmpeq_epi8_mask(data, _mm512_set1_epi8(']'))
+                    | _mm512_cmpeq_epi8_mask(data, _mm512_set1_epi8(':'))
+                    | _mm512_cmpeq_epi8_mask(data, _mm512_set1_epi8(','))
+                    | _mm512_cmpeq_epi8_mask(data, _mm512_set1_epi8('"'));
+                count += append_offsets(mask, static_cast<uint32_t>(cur - begin), out + count);
+                cur += 64;
+            }
+            size_t tail = structural_index_scalar(cur, end, out + count);
+            for(size_t i = count; i < count + tail; ++i) {
+                out[i] += static_cast<uint32_t>(cur - begin);
+            }
+            return count + tail;
+        }
+
+        __attribute__((target("avx512f,avx512bw")))
+        inline bool validate_utf8_avx512(const char* begin, const char* end) {
+            const unsigned char* cur = reinterpret_cast<const unsigned char*>(begin);
+            const unsigned char* last = reinterpret_cast<const unsigned char*>(end);
+            while(cur != last) {
+                if(last - cur >= 64) {
+                    __m512i data = _mm512_loadu_si512(reinterpret_cast<const void*>(cur));
+                    if(_mm512_movepi8_mask(data) == 0) {
+                        cur += 64;
+                        continue;
+                    }
+                }
+                cur = next_utf8_char(cur, last);
+                if(cur == nullptr)
+                    return false;
+            }
+            return true;
+        }
+#endif
+
+        inline const Kernels scalar_kernels = {
+            SimdLevel::Scalar, skip_whitespace_scalar, scan_string_scalar, structural_index_scalar, validate_utf8_scalar
+        };
+
+#ifdef SIMPLE_JSON_PARSER_X86_DISPATCH
+        inline const Kernels sse42_kernels = {
+            SimdLevel::SSE42, skip_whitespace_sse42, scan_string_sse42, structural_index_sse42, validate_utf8_sse42
+        };
+
+        inline const Kernels avx2_kernels = {
+            SimdLevel::AVX2, skip_whitespace_avx2, scan_string_avx2, structural_index_avx2, validate_utf8_avx2
+        };
+
+        inline const Kernels avx512_kernels = {
+            SimdLevel::AVX512, skip_whitespace_avx512, scan_string_avx512, structural_index_avx512, validate_utf8_avx512
+        };
+#endif
+
+        inline std::atomic<const Kernels*> active_kernels{nullptr};
+    }
+
+    /* Highest level both this build and the running CPU support */
+    inline SimdLevel detect_simd_level() {
+#ifdef SIMPLE_JSON_PARSER_X86_DISPATCH
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+            return SimdLevel::AVX512;
+        if(__builtin_cpu_supports("avx2"))
+            return SimdLevel::AVX2;
+        if(__builtin_cpu_supports("sse4.2"))
+            return SimdLevel::SSE42;
+#endif
+        return SimdLevel::Scalar;
+    }
+
+    /* Accepts "scalar", "sse4.2", "avx2" and "avx512" */
+    inline bool parse_simd_level(const char* name, SimdLevel& level) {
+        if(std::strcmp(name, "scalar") == 0)
+            level = SimdLevel::Scalar;
+        else if(std::strcmp(name, "sse4.2") == 0)
+            level = SimdLevel::SSE42;
+        else if(std::strcmp(name, "avx2") == 0)
+            level = SimdLevel::AVX2;
+        else if(std::strcmp(name, "avx512") == 0)
+            level = SimdLevel::AVX512;
+        else
+            return false;
+        return true;
+    }
+
+    /* The kernels of one level; the caller must make sure the CPU supports it */
+    inline const Kernels& kernels_for(SimdLevel level) {
+#ifdef SIMPLE_JSON_PARSER_X86_DISPATCH
+        if(level == SimdLevel::AVX512)
+            return detail::avx512_kernels;
+        if(level == SimdLevel::AVX2)
+            return detail::avx2_kernels;
+        if(level == SimdLevel::SSE42)
+            return detail::sse42_kernels;
+#endif
+        return detail::scalar_kernels;
+    }
+
+    /*
+     * The kernels the parser uses. They are picked on first use from the detected CPU
+     * features; SIMPLE_JSON_PARSER_SIMD_LEVEL can lower the level, and set_simd_level()
+     * changes it afterwards.
+     */
+    inline const Kernels& kernels() {
+        const Kernels* active = detail::active_kernels.load(std::memory_order_acquire);
+        if(active == nullptr) {
+            SimdLevel level = detect_simd_level();
+            SimdLevel requested;
+            const char* env = std::getenv("SIMPLE_JSON_PARSER_SIMD_LEVEL");
+            if(env != nullptr && parse_simd_level(env, requested) && requested < level) {
+                level = requested;
+            }
+            active = &kernels_for(level);
+            detail::active_kernels.store(active, std::memory_order_release);
+        }
+        return *active;
+    }
+
+    /* Forces a level; returns false and keeps the current one if the CPU lacks it */
+    inline bool set_simd_level(SimdLevel level) {
+        if(level > detect_simd_level()) {
+            return false;
+        }
+        detail::active_kernels.store(&kernels_for(level), std::memory_order_release);
+        return true;
+    }
+
+    inline SimdLevel simd_level() {
+        return kernels().level;
+    }
+}
+
+#endif
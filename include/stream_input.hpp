@@ -0,0 +1,632 @@
+#ifndef SIMPLE_JSON_PARSER_STREAM_INPUT
+#define SIMPLE_JSON_PARSER_STREAM_INPUT
+
+#include "error.hpp"
+#include "document.hpp"
+#include "parser.hpp"
+#include "parser_impl.hpp"
+#include "array_reader.hpp"
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef SIMPLE_JSON_PARSER_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef SIMPLE_JSON_PARSER_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace SimpleJsonParser {
+
+    /* Produces the plain bytes of an input. read() returns 0 at the end and throws on a corrupt input. */
+    class InputSource {
+        public:
+            virtual ~InputSource() = default;
+            virtual size_t read(char* out, size_t capacity) = 0;
+    };
+
+    class FileSource : public InputSource {
+        public:
+            explicit FileSource(const std::string& filename) : m_file(std::fopen(filename.c_str(), "rb")) {
+                if(m_file == nullptr)
+                    throw std::runtime_error("Cannot open " + filename);
+            }
+
+            ~FileSource() override { std::fclose(m_file); }
+
+            size_t read(char* out, size_t capacity) override {
+                size_t size = std::fread(out, 1, capacity, m_file);
+                if(size == 0 && std::ferror(m_file))
+                    throw std::runtime_error("Read error");
+                return size;
+            }
+
+        private:
+            std::FILE* m_file;
+    };
+
+#ifdef SIMPLE_JSON_PARSER_HAS_ZLIB
+    /* gzip (or zlib) stream; concatenated gzip members are read one after the other */
+    class GzipSource : public InputSource {
+        public:
+            explicit GzipSource(const std::string& filename) : m_source(filename), m_input(input_size) {
+                std::memset(&m_stream, 0, sizeof(m_stream));
+                if(inflateInit2(&m_stream, 15 + 32) != Z_OK)
+                    throw std::runtime_error("Cannot initialize zlib");
+            }
+
+            ~GzipSource() override { inflateEnd(&m_stream); }
+
+            size_t read(char* out, size_t capacity) override {
+                m_stream.next_out = reinterpret_cast<Bytef*>(out);
+                m_stream.avail_out = static_cast<uInt>(capacity);
+
+                while(m_stream.avail_out != 0) {
+                    if(m_stream.avail_in == 0) {
+                        if(m_input_done)
+                            break;
+                        size_t size = m_source.read(m_input.data(), m_input.size());
+                        if(size == 0) {
+                            m_input_done = true;
+                            if(!m_stream_ended)
+                                throw std::runtime_error("Truncated gzip stream");
+                            break;
+                        }
+                        m_stream.next_in = reinterpret_cast<Bytef*>(m_input.data());
+                        m_stream.avail_in = static_cast<uInt>(size);
+                    }
+
+                    if(m_stream_ended) {
+                        /* Another member follows the one that just ended */
+                        inflateReset(&m_stream);
+                        m_stream_ended = false;
+                    }
+
+                    int status = inflate(&m_stream, Z_NO_FLUSH);
+                    if(status == Z_STREAM_END) {
+                        m_stream_ended = true;
+                    }
+                    else if(status != Z_OK && status != Z_BUF_ERROR) {
+                        throw std::runtime_error("Corrupt gzip stream");
+                    }
+                }
+
+                return capacity - m_stream.avail_out;
+            }
+
+        private:
+            static constexpr size_t input_size = 256 * 1024;
+
+            FileSource m_source;
+            std::vector<char> m_input;
+            z_stream m_stream;
+            bool m_input_done = false;
+            bool m_stream_ended = false;
+    };
+#endif
+
+#ifdef SIMPLE_JSON_PARSER_HAS_ZSTD
+    class ZstdSource : public InputSource {
+        public:
+            explicit ZstdSource(const std::string& filename)
+                : m_source(filename), m_input(ZSTD_DStreamInSize()), m_stream(ZSTD_createDStream()) {
+                if(m_stream == nullptr)
+                    throw std::runtime_error("Cannot initialize zstd");
+                ZSTD_initDStream(m_stream);
+                m_in = ZSTD_inBuffer{m_input.data(), 0, 0};
+            }
+
+            ~ZstdSource() override { ZSTD_freeDStream(m_stream); }
+
+            size_t read(char* out, size_t capacity) override {
+                ZSTD_outBuffer output{out, capacity, 0};
+                while(output.pos < output.size) {
+                    if(m_in.pos == m_in.size) {
+                        size_t size = m_source.read(m_input.data(), m_input.size());
+                        if(size == 0) {
+                            if(m_frame_open)
+                                throw std::runtime_error("Truncated zstd stream");
+                            break;
+                        }
+                        m_in = ZSTD_inBuffer{m_input.data(), size, 0};
+                    }
+
+                    size_t status = ZSTD_decompressStream(m_stream, &output, &m_in);
+                    if(ZSTD_isError(status))
+                        throw std::runtime_error("Corrupt zstd stream");
+                    m_frame_open = status != 0;
+                }
+                return output.pos;
+            }
+
+        private:
+            FileSource m_source;
+            std::vector<char> m_input;
+            ZSTD_DStream* m_stream;
+            ZSTD_inBuffer m_in;
+            bool m_frame_open = false;
+    };
+#endif
+
+    /* Picks the decompressor from the magic bytes of the file; anything unrecognized is read as is */
+    inline std::unique_ptr<InputSource> open_input_source(const std::string& filename) {
+        unsigned char magic[4] = {0, 0, 0, 0};
+        {
+            FileSource probe(filename);
+            probe.read(reinterpret_cast<char*>(magic), sizeof(magic));
+        }
+
+        if(magic[0] == 0x1f && magic[1] == 0x8b) {
+#ifdef SIMPLE_JSON_PARSER_HAS_ZLIB
+            return std::make_unique<GzipSource>(filename);
+#else
+            throw std::runtime_error("gzip support is not compiled in");
+#endif
+        }
+        if(magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+#ifdef SIMPLE_JSON_PARSER_HAS_ZSTD
+            return std::make_unique<ZstdSource>(filename);
+#else
+            throw std::runtime_error("zstd support is not compiled in");
+#endif
+        }
+        return std::make_unique<FileSource>(filename);
+    }
+
+    /*
+     * Reads an InputSource on a producer thread into a ring of fixed-size buffers.
+     * The consumer holds one buffer at a time; once every buffer is full or held,
+     * the producer waits, so memory stays at num_chunks * chunk_size. Each buffer is
+     * followed by chunk_padding zero bytes so scanning kernels may read past the end.
+     */
+    class PipelinedInput {
+        public:
+            static constexpr size_t default_chunk_size = 1024 * 1024;
+            static constexpr size_t default_num_chunks = 4;
+            static constexpr size_t chunk_padding = 64;
+
+            explicit PipelinedInput(std::unique_ptr<InputSource> source, size_t chunk_size=default_chunk_size, size_t num_chunks=default_num_chunks)
+                : m_source(std::move(source)), m_chunk_size(chunk_size), m_chunks(num_chunks < 2 ? 2 : num_chunks) {
+                for(Chunk& chunk : m_chunks) {
+                    chunk.data = std::make_unique<char[]>(m_chunk_size + chunk_padding);
+                }
+                m_worker = std::thread([this] { produce(); });
+            }
+
+            PipelinedInput(const PipelinedInput&) = delete;
+            PipelinedInput& operator=(const PipelinedInput&) = delete;
+
+            ~PipelinedInput() {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stopped = true;
+                }
+                m_not_full.notify_all();
+                m_worker.join();
+            }
+
+            /*
+             * Hands out the next chunk and takes back the previous one, which must not be
+             * used afterwards. Returns false at the end of the input and rethrows errors
+             * raised by the source.
+             */
+            bool next_chunk(const char*& data, size_t& size) {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if(m_held) {
+                    m_held = false;
+                    m_not_full.notify_one();
+                }
+
+                m_not_empty.wait(lock, [this] { return m_full != 0 || m_done; });
+                if(m_full == 0) {
+                    if(m_error)
+                        std::rethrow_exception(m_error);
+                    return false;
+                }
+
+                Chunk& chunk = m_chunks[m_read];
+                m_read = (m_read + 1) % m_chunks.size();
+                --m_full;
+                m_held = true;
+                data = chunk.data.get();
+                size = chunk.size;
+                return true;
+            }
+
+        private:
+            struct Chunk {
+                std::unique_ptr<char[]> data;
+                size_t size = 0;
+            };
+
+            void produce() {
+                try {
+                    while(true) {
+                        {
+                            std::unique_lock<std::mutex> lock(m_mutex);
+                            m_not_full.wait(lock, [this] { return m_full + (m_held ? 1 : 0) < m_chunks.size() || m_stopped; });
+                            if(m_stopped)
+                                break;
+                        }
+
+                        /* The slot at m_write is neither full nor held, so it is filled without the lock */
+                        Chunk& chunk = m_chunks[m_write];
+                        chunk.size = fill(chunk.data.get());
+                        if(chunk.size == 0)
+                            break;
+                        std::memset(chunk.data.get() + chunk.size, 0, chunk_padding);
+
+                        {
+                            std::lock_guard<std::mutex> lock(m_mutex);
+                            m_write = (m_write + 1) % m_chunks.size();
+                            ++m_full;
+                        }
+                        m_not_empty.notify_one();
+                    }
+                }
+                catch(...) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_error = std::current_exception();
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_done = true;
+                }
+                m_not_empty.notify_all();
+            }
+
+            size_t fill(char* out) {
+                size_t size = 0;
+                while(size < m_chunk_size) {
+                    size_t read = m_source->read(out + size, m_chunk_size - size);
+                    if(read == 0)
+                        break;
+                    size += read;
+                }
+                return size;
+            }
+
+            std::unique_ptr<InputSource> m_source;
+            size_t m_chunk_size;
+            std::vector<Chunk> m_chunks;
+            size_t m_read = 0;
+            size_t m_write = 0;
+            size_t m_full = 0;
+            bool m_held = false;
+            bool m_stopped = false;
+            bool m_done = false;
+            std::exception_ptr m_error;
+            std::mutex m_mutex;
+            std::condition_variable m_not_empty;
+            std::condition_variable m_not_full;
+            std::thread m_worker;
+    };
+
+    /* A parser for input that must hold exactly one value, optionally surrounded by whitespace */
+    class SingleValueParser : public NormalParser {
+        public:
+            using NormalParser::NormalParser;
+
+            ParseResult parse_single(const char* begin, const char* end) {
+                ParseResult result = parse(begin, end);
+                if(!result.m_error_info.is_error() && m_cur != m_end) {
+                    set_unexpected_error(ErrorCode::eExtraCharactersAfterValue);
+                    return ParseResult{m_error_info, Value()};
+                }
+                return result;
+            }
+    };
+
+    /*
+     * Parses newline-delimited JSON from a PipelinedInput while the producer keeps
+     * decompressing. Lines inside one chunk are parsed in place; only lines that
+     * straddle two chunks are copied. Blank lines are skipped.
+     */
+    class NdjsonReader {
+        public:
+            using Iterator = ElementIterator<NdjsonReader>;
+
+            explicit NdjsonReader(PipelinedInput& input, const ParserSettings& settings=ParserSettings{})
+                : m_input(input), m_parser(settings) {}
+
+            /*
+             * Returns false at the end of the input or at the first malformed line, including
+             * a line with anything but whitespace after its value; error_info() tells the two apart.
+             */
+            bool next(Value& value) {
+                const char* begin;
+                const char* end;
+                while(!m_finished && next_line(begin, end)) {
+                    ++m_line_number;
+                    const char* first = m_kernels.skip_whitespace(begin, end);
+                    if(first == end)
+                        continue;
+
+                    ParseResult result = m_parser.parse_single(begin, end);
+                    if(result.m_error_info.is_error()) {
+                        m_error_info = ErrorInfo(result.m_error_info.error_code(), m_line_number, result.m_error_info.offset());
+                        m_finished = true;
+                        return false;
+                    }
+                    value = std::move(result.m_value);
+                    return true;
+                }
+
+                m_finished = true;
+                return false;
+            }
+
+            const ErrorInfo& error_info() const { return m_error_info; }
+            size_t line_number() const { return m_line_number; }
+
+            Iterator begin() { return Iterator(this); }
+            Iterator end() { return Iterator(); }
+
+        private:
+            bool next_line(const char*& begin, const char*& end) {
+                m_carry.clear();
+                while(true) {
+                    if(m_cur != m_end) {
+                        const char* newline = static_cast<const char*>(std::memchr(m_cur, '\n', m_end - m_cur));
+                        if(newline != nullptr) {
+                            if(m_carry.empty()) {
+                                begin = m_cur;
+                                end = newline;
+                            }
+                            else {
+                                m_carry.append(m_cur, newline);
+                                begin = m_carry.data();
+                                end = m_carry.data() + m_carry.size();
+                            }
+                            m_cur = newline + 1;
+                            return true;
+                        }
+                        m_carry.append(m_cur, m_end);
+                        m_cur = m_end;
+                    }
+
+                    const char* data;
+                    size_t size;
+                    if(!m_input.next_chunk(data, size)) {
+                        /* Last line without a trailing newline */
+                        begin = m_carry.data();
+                        end = m_carry.data() + m_carry.size();
+                        return !m_carry.empty();
+                    }
+                    m_cur = data;
+                    m_end = data + size;
+                }
+            }
+
+            PipelinedInput& m_input;
+            SingleValueParser m_parser;
+            const Kernels& m_kernels = kernels();
+            const char* m_cur = nullptr;
+            const char* m_end = nullptr;
+            std::string m_carry;
+            size_t m_line_number = 0;
+            bool m_finished = false;
+            ErrorInfo m_error_info;
+    };
+
+    /*
+     * Pulls the elements of a top-level array from a PipelinedInput while the producer
+     * keeps decompressing. Only the unconsumed tail of the input is buffered, so memory
+     * is bounded by the chunks in flight plus about twice the largest element.
+     * An element cut by a chunk boundary is parsed again once more input has arrived.
+     * Elements outside the projection in the settings are validated but not returned.
+     */
+    class PipelinedArrayReader : protected NormalParser {
+        public:
+            using Iterator = ElementIterator<PipelinedArrayReader>;
+
+            explicit PipelinedArrayReader(PipelinedInput& input, const ParserSettings& settings=ParserSettings{})
+                : NormalParser(settings), m_input(input) {}
+
+            /*
+             * Returns false once the array is exhausted or malformed; error_info() tells the two
+             * apart. Offsets in errors count from the start of the input. Rethrows source errors.
+             */
+            bool next(Value& value);
+
+            const ErrorInfo& error_info() const { return m_error; }
+
+            Iterator begin() { return Iterator(this); }
+            Iterator end() { return Iterator(); }
+
+        private:
+            enum class State { Start, First, Next, Done };
+            enum class Step { Element, Skipped, End, NeedMore, Error };
+
+            /* Errors this close to the end of the buffer may come from a token cut in half */
+            static constexpr size_t token_lookahead = 8;
+
+            Step parse_step(Value& value);
+            bool may_be_cut(size_t offset) const;
+            Step incomplete(ErrorCode error_code);
+            Step fail();
+            void refill();
+
+            void commit() { m_pos = m_cur - m_buffer.data(); }
+
+            PipelinedInput& m_input;
+            std::string m_buffer;
+            size_t m_pos = 0;
+            /* Bytes of the input already dropped from the front of m_buffer */
+            size_t m_consumed = 0;
+            size_t m_origin = 0;
+            /* Index of the next element, for the projection */
+            size_t m_index = 0;
+            State m_state = State::Start;
+            bool m_input_done = false;
+            bool m_finished = false;
+            ErrorInfo m_error;
+    };
+
+    inline bool PipelinedArrayReader::next(Value& value) {
+        while(!m_finished) {
+            Step step = parse_step(value);
+            if(step == Step::Element) {
+                return true;
+            }
+            if(step == Step::NeedMore) {
+                refill();
+            }
+            else if(step != Step::Skipped) {
+                m_finished = true;
+            }
+        }
+        return false;
+    }
+
+    inline PipelinedArrayReader::Step PipelinedArrayReader::parse_step(Value& value) {
+        if(m_state == State::Done) {
+            return Step::End;
+        }
+
+        init_parser_state(m_buffer.data() + m_pos, m_buffer.data() + m_buffer.size());
+        m_origin = m_consumed + m_pos;
+        /* Every attempt starts inside the array once its bracket is consumed */
+        m_depth = m_state == State::Start ? 0 : 1;
+
+        skip_whitespace();
+        if(m_state == State::Start) {
+            if(m_cur == m_end) {
+                return incomplete(ErrorCode::eNoCorrespondingValue);
+            }
+            if(*m_cur != '[') {
+                if(may_be_cut(m_cur - m_begin)) {
+                    return Step::NeedMore;
+                }
+                set_error(ErrorCode::eNoCorrespondingValue);
+                return fail();
+            }
+            ++m_cur;
+            if(++m_depth > settings().max_depth_object) {
+                set_error(ErrorCode::eObjectDepthLimitExceed);
+                return fail();
+            }
+            m_state = State::First;
+            commit();
+            skip_whitespace();
+        }
+
+        if(m_cur == m_end) {
+            return incomplete(ErrorCode::eMissingCommaOrSquareBracket);
+        }
+        if(m_state == State::First && *m_cur == ']') {
+            ++m_cur;
+            commit();
+            m_state = State::Done;
+            return Step::End;
+        }
+
+        size_t node = settings().projection.start();
+        size_t child = node == Projection::all ? Projection::all : settings().projection.element(node, m_index);
+        bool selected = !skip_projected(child);
+        Value element;
+        if(selected) {
+            element = parse_value(child);
+        }
+        if(selected ? element.type() == ValueType::Uninitialized : !skip_value()) {
+            set_error(ErrorCode::eNoCorrespondingValue);
+            return may_be_cut(m_error_info.offset()) ? Step::NeedMore : fail();
+        }
+
+        /* A number or comment may continue in the next chunk, and the separator is not there yet */
+        if(m_cur == m_end) {
+            return incomplete(ErrorCode::eMissingCommaOrSquareBracket);
+        }
+        if(*m_cur == ',') {
+            m_state = State::Next;
+        }
+        else if(*m_cur == ']') {
+            m_state = State::Done;
+        }
+        else if(may_be_cut(m_cur - m_begin)) {
+            return Step::NeedMore;
+        }
+        else {
+            set_unexpected_error(ErrorCode::eMissingCommaOrSquareBracket);
+            return fail();
+        }
+        ++m_cur;
+        ++m_index;
+        commit();
+
+        if(!selected) {
+            return Step::Skipped;
+        }
+        value = std::move(element);
+        return Step::Element;
+    }
+
+    /*
+     * Whether an error at offset from the start of this attempt might go away with more input:
+     * a short token at the end of the buffer, or a comment that is not closed yet.
+     */
+    inline bool PipelinedArrayReader::may_be_cut(size_t offset) const {
+        if(m_input_done) {
+            return false;
+        }
+        return static_cast<size_t>(m_end - m_begin) - offset <= token_lookahead || m_begin[offset] == '/';
+    }
+
+    inline PipelinedArrayReader::Step PipelinedArrayReader::incomplete(ErrorCode error_code) {
+        if(!m_input_done) {
+            return Step::NeedMore;
+        }
+        set_error(error_code);
+        return fail();
+    }
+
+    inline PipelinedArrayReader::Step PipelinedArrayReader::fail() {
+        m_error = ErrorInfo(m_error_info.error_code(), m_error_info.line_number(), m_origin + m_error_info.offset());
+        return Step::Error;
+    }
+
+    /* Drops the consumed bytes and at least doubles what is left, so an element is parsed O(1) times on average */
+    inline void PipelinedArrayReader::refill() {
+        m_buffer.erase(0, m_pos);
+        m_consumed += m_pos;
+        m_pos = 0;
+
+        size_t target = m_buffer.size() * 2 + 1;
+        const char* data;
+        size_t size;
+        while(m_buffer.size() < target) {
+            if(!m_input.next_chunk(data, size)) {
+                m_input_done = true;
+                break;
+            }
+            m_buffer.append(data, size);
+        }
+    }
+
+    /*
+     * Parses a whole document. The parser needs it contiguous, so the document is
+     * gathered in memory first and only decompression overlaps with the gathering;
+     * nothing bounds the memory. Use PipelinedArrayReader for top-level arrays.
+     */
+    inline ParseResult parse_document(PipelinedInput& input, ParserBase& parser) {
+        std::string text;
+        const char* data;
+        size_t size;
+        while(input.next_chunk(data, size)) {
+            text.append(data, size);
+        }
+        return parser.parse(text.data(), text.data() + text.size());
+    }
+}
+
+#endif
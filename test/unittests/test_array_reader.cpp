@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "array_reader.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using SimpleJsonParser::ArrayElementReader;
+using SimpleJsonParser::ErrorCode;
+using SimpleJsonParser::NormalParser;
+using SimpleJsonParser::ParserSettings;
+using SimpleJsonParser::Projection;
+using SimpleJsonParser::ReadAheadArrayReader;
+using SimpleJsonParser::Value;
+
+TEST(ArrayElementReaderTest, TestReadsElementsInOrder) {
+    std::string json = " [ 1.5, \"two\", [3, 4], {\"five\": true}, null ] ";
+    ArrayElementReader reader(json.data(), json.data() + json.size());
+
+    std::vector<Value> values;
+    for(Value& value : reader) {
+        values.push_back(std::move(value));
+    }
+
+    ASSERT_EQ(values.size(), 5);
+    ASSERT_EQ(values[0].fraction(), 1.5);
+    ASSERT_EQ(values[1].string(), "two");
+    ASSERT_EQ(values[2].size_array(), 2);
+    ASSERT_TRUE(values[3]["five"].boolean());
+    ASSERT_TRUE(values[4].is_null());
+    ASSERT_FALSE(reader.error_info().is_error());
+}
+
+TEST(ArrayElementReaderTest, TestEmptyArray) {
+    std::string json = "[ ]";
+    ArrayElementReader reader(json.data(), json.data() + json.size());
+    Value value;
+    ASSERT_FALSE(reader.next(value));
+    ASSERT_FALSE(reader.error_info().is_error());
+}
+
+TEST(ArrayElementReaderTest, TestReportsMalformedArray) {
+    std::string json = "[1, 2 3]";
+    ArrayElementReader reader(json.data(), json.data() + json.size());
+    Value value;
+    ASSERT_TRUE(reader.next(value));
+    ASSERT_FALSE(reader.next(value));
+    ASSERT_EQ(reader.error_info().error_code(), ErrorCode::eMissingCommaOrSquareBracket);
+
+    std::string not_array = "{\"a\": 1}";
+    ArrayElementReader object_reader(not_array.data(), not_array.data() + not_array.size());
+    ASSERT_FALSE(object_reader.next(value));
+    ASSERT_TRUE(object_reader.error_info().is_error());
+}
+
+TEST(ArrayElementReaderTest, TestDepthLimitCountsTheArray) {
+    ParserSettings settings;
+    settings.max_depth_object = 2;
+
+    std::string json = "[[1], [[1]]]";
+    ArrayElementReader reader(json.data(), json.data() + json.size(), settings);
+    Value value;
+    ASSERT_TRUE(reader.next(value));
+    ASSERT_FALSE(reader.next(value));
+    ASSERT_EQ(reader.error_info().error_code(), ErrorCode::eObjectDepthLimitExceed);
+    ASSERT_EQ(NormalParser(settings).parse(json).m_error_info.error_code(), ErrorCode::eObjectDepthLimitExceed);
+
+    settings.max_depth_object = 0;
+    std::string flat = "[1]";
+    ArrayElementReader flat_reader(flat.data(), flat.data() + flat.size(), settings);
+    ASSERT_FALSE(flat_reader.next(value));
+    ASSERT_EQ(flat_reader.error_info().error_code(), ErrorCode::eObjectDepthLimitExceed);
+}
+
+TEST(ArrayElementReaderTest, TestHonorsProjection) {
+    std::string json = "[{\"id\": 1, \"name\": \"a\"}, 2, {\"id\": 3}, [4], {\"name\": \"e\"}]";
+    for(const char* pointer : {"/*/id", "/2", "/x"}) {
+        ParserSettings settings;
+        settings.projection = Projection::compile({pointer});
+        Value expected = NormalParser(settings).parse(json).m_value;
+
+        ArrayElementReader reader(json.data(), json.data() + json.size(), settings);
+        size_t count = 0;
+        for(Value& value : reader) {
+            ASSERT_EQ(value, expected[count]) << pointer;
+            ++count;
+        }
+        ASSERT_EQ(count, expected.size_array()) << pointer;
+        ASSERT_FALSE(reader.error_info().is_error()) << pointer;
+    }
+}
+
+TEST(ArrayElementReaderTest, TestIteratorWorksWithAlgorithms) {
+    std::string json = "[1, \"two\", 3, null, 5]";
+    ArrayElementReader reader(json.data(), json.data() + json.size());
+    ptrdiff_t numbers = std::count_if(reader.begin(), reader.end(), [](const Value& value) { return value.is_integer() || value.is_fraction(); });
+    ASSERT_EQ(numbers, 3);
+
+    ArrayElementReader second(json.data(), json.data() + json.size());
+    ArrayElementReader::Iterator it = second.begin();
+    ArrayElementReader::Iterator copy = it;
+    ASSERT_EQ((*copy).fraction(), 1.0);
+    ASSERT_EQ((*it++).fraction(), 1.0);
+    ASSERT_EQ(it->string(), "two");
+    ASSERT_EQ(copy->string(), "two");
+}
+
+TEST(ReadAheadArrayReaderTest, TestMatchesArrayElementReader) {
+    std::string json = "[";
+    for(int i = 0; i < 1000; ++i) {
+        json += (i == 0 ? "" : ",") + std::string("{\"id\": ") + std::to_string(i) + ", \"tags\": [\"a\", \"b\"]}";
+    }
+    json += "]";
+
+    ArrayElementReader reader(json.data(), json.data() + json.size());
+    ReadAheadArrayReader read_ahead(json.data(), json.data() + json.size(), 4);
+
+    size_t count = 0;
+    Value expected;
+    for(Value& value : read_ahead) {
+        ASSERT_TRUE(reader.next(expected));
+        ASSERT_EQ(value, expected);
+        ++count;
+    }
+    ASSERT_EQ(count, 1000);
+    ASSERT_FALSE(reader.next(expected));
+    ASSERT_FALSE(read_ahead.error_info().is_error());
+}
+
+TEST(ReadAheadArrayReaderTest, TestStopsEarly) {
+    std::string json = "[1, 2, 3, 4, 5, 6, 7, 8]";
+    ReadAheadArrayReader read_ahead(json.data(), json.data() + json.size());
+    Value value;
+    ASSERT_TRUE(read_ahead.next(value));
+    ASSERT_EQ(value.fraction(), 1.0);
+}
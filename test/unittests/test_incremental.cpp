@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "incremental.hpp"
+#include <random>
+#include <string>
+#include <vector>
+
+using SimpleJsonParser::ErrorCode;
+using SimpleJsonParser::IncrementalDocument;
+using SimpleJsonParser::NormalParser;
+using SimpleJsonParser::ParserSettings;
+using SimpleJsonParser::SourceSpan;
+
+/* The document must look exactly as if its current text had been parsed from scratch */
+static void expect_fresh(const IncrementalDocument& doc) {
+    IncrementalDocument fresh(doc.text());
+    ASSERT_EQ(doc.error_info().is_error(), fresh.error_info().is_error());
+    ASSERT_EQ(doc.value(), fresh.value());
+    ASSERT_EQ(doc.value(), NormalParser().parse(doc.text()).m_value);
+
+    const std::vector<SourceSpan>& spans = doc.spans();
+    const std::vector<SourceSpan>& expected = fresh.spans();
+    ASSERT_EQ(spans.size(), expected.size());
+    for(size_t i = 0; i < spans.size(); ++i) {
+        ASSERT_EQ(spans[i].begin, expected[i].begin) << i;
+        ASSERT_EQ(spans[i].end, expected[i].end) << i;
+        ASSERT_EQ(spans[i].parent, expected[i].parent) << i;
+        ASSERT_EQ(spans[i].index, expected[i].index) << i;
+        ASSERT_EQ(spans[i].key, expected[i].key) << i;
+        ASSERT_EQ(spans[i].duplicate_keys, expected[i].duplicate_keys) << i;
+    }
+}
+
+TEST(IncrementalTest, TestRecordsSpans) {
+    std::string json = "{\"a\": [1, {\"b\": 2}], \"c\": {}}";
+    IncrementalDocument doc(json);
+    ASSERT_FALSE(doc.error_info().is_error());
+
+    const std::vector<SourceSpan>& spans = doc.spans();
+    ASSERT_EQ(spans.size(), 4);
+    ASSERT_EQ(spans[0].begin, 0);
+    ASSERT_EQ(spans[0].end, json.size());
+    ASSERT_EQ(spans[0].parent, SourceSpan::npos);
+    ASSERT_EQ(json.substr(spans[1].begin, spans[1].end - spans[1].begin), "[1, {\"b\": 2}]");
+    ASSERT_EQ(spans[1].key, "a");
+    ASSERT_EQ(spans[2].parent, 1);
+    ASSERT_EQ(spans[2].index, 1);
+    ASSERT_EQ(spans[3].key, "c");
+}
+
+TEST(IncrementalTest, TestLocalEdits) {
+    IncrementalDocument doc("{\"a\": [1, {\"b\": 2}], \"c\": {\"d\": [3]}, \"e\": [[4], [5]]}");
+
+    /* Replace 2 by a larger value inside {"b": 2} */
+    ASSERT_TRUE(doc.apply_edit(doc.text().find('2'), 1, "[20, {\"x\": null}]"));
+    expect_fresh(doc);
+    ASSERT_EQ(doc.value()["a"][1]["b"].size_array(), 2);
+
+    /* Remove text, so later spans move left */
+    ASSERT_TRUE(doc.apply_edit(doc.text().find("1,"), 3, ""));
+    expect_fresh(doc);
+    ASSERT_EQ(doc.value()["a"].size_array(), 1);
+
+    /* Insert a member */
+    ASSERT_TRUE(doc.apply_edit(doc.text().find("\"d\""), 0, "\"n\": {\"m\": []}, "));
+    expect_fresh(doc);
+    ASSERT_TRUE(doc.value()["c"]["n"].is_object());
+
+    ASSERT_TRUE(doc.apply_edit(doc.text().find('5'), 1, "6"));
+    expect_fresh(doc);
+    ASSERT_EQ(doc.value()["e"][1][0].fraction(), 6);
+}
+
+TEST(IncrementalTest, TestFallsBackToFullParse) {
+    IncrementalDocument doc("{\"a\": [1, 2], \"b\": 3}");
+
+    /* Closing the array early leaves it unparseable on its own */
+    ASSERT_FALSE(doc.apply_edit(doc.text().find(','), 1, "], \"x\": ["));
+    expect_fresh(doc);
+    ASSERT_TRUE(doc.value()["x"].is_array());
+
+    /* Touching the outermost brackets */
+    ASSERT_FALSE(doc.apply_edit(0, 1, "[{"));
+    ASSERT_FALSE(doc.apply_edit(doc.text().size(), 0, "]"));
+    expect_fresh(doc);
+    ASSERT_TRUE(doc.value().is_array());
+
+    /* A broken document stays broken until an edit repairs it */
+    size_t close = doc.text().size() - 1;
+    ASSERT_FALSE(doc.apply_edit(close, 1, ""));
+    ASSERT_EQ(doc.error_info().error_code(), ErrorCode::eMissingCommaOrSquareBracket);
+    ASSERT_FALSE(doc.apply_edit(close, 0, "]"));
+    expect_fresh(doc);
+    ASSERT_FALSE(doc.error_info().is_error());
+
+    ASSERT_THROW(doc.apply_edit(doc.text().size(), 1, ""), std::out_of_range);
+}
+
+TEST(IncrementalTest, TestCommentAfterRegionFallsBack) {
+    /* Inside the region the comment would stop at the region end; in the document it runs to the end of the line */
+    IncrementalDocument doc("[[1, 2], 3]");
+    ASSERT_FALSE(doc.apply_edit(doc.text().find('2') + 1, 0, "] //"));
+    ASSERT_TRUE(doc.error_info().is_error());
+    expect_fresh(doc);
+
+    IncrementalDocument fixed("[[1, 2], 3]");
+    ASSERT_TRUE(fixed.apply_edit(fixed.text().find('2') + 1, 0, " // two\n"));
+    expect_fresh(fixed);
+    ASSERT_EQ(fixed.value()[0].size_array(), 2);
+}
+
+TEST(IncrementalTest, TestDuplicateKeys) {
+    /* The first "a" is replaced by the second, so an edit inside it must reparse the whole object */
+    IncrementalDocument doc("[{\"a\": [1], \"a\": [2]}]");
+    ASSERT_TRUE(doc.spans()[1].duplicate_keys);
+
+    ASSERT_TRUE(doc.apply_edit(doc.text().find('1'), 1, "7"));
+    expect_fresh(doc);
+    ASSERT_EQ(doc.value()[0]["a"][0].fraction(), 2);
+
+    ASSERT_TRUE(doc.apply_edit(doc.text().find('2'), 1, "8"));
+    expect_fresh(doc);
+    ASSERT_EQ(doc.value()[0]["a"][0].fraction(), 8);
+}
+
+TEST(IncrementalTest, TestDepthLimitCountsEnclosingContainers) {
+    ParserSettings settings;
+    settings.max_depth_object = 2;
+    IncrementalDocument doc("[[1], 2]", settings);
+    ASSERT_FALSE(doc.error_info().is_error());
+
+    ASSERT_FALSE(doc.apply_edit(doc.text().find('1'), 1, "[1]"));
+    ASSERT_EQ(doc.error_info().error_code(), ErrorCode::eObjectDepthLimitExceed);
+}
+
+TEST(IncrementalTest, TestRandomEditsMatchFullParse) {
+    IncrementalDocument doc("{\"a\": [1, 2, {\"b\": [3, \"s\"]}], \"c\": {\"d\": [[4], {}], \"e\": \"t\"}, \"f\": [5]}");
+    const std::vector<std::string> pieces = {"7", ", 8", "[]", "{}", "[9]", "\"k\": 1, ", "]", "}", ",", "\"", " ", "//", "\n"};
+
+    std::mt19937 rng(42);
+    size_t local = 0;
+    for(int i = 0; i < 2000; ++i) {
+        size_t offset = rng() % (doc.text().size() + 1);
+        size_t removed = std::min<size_t>(rng() % 3, doc.text().size() - offset);
+        std::string original = doc.text().substr(offset, removed);
+        const std::string& inserted = pieces[rng() % pieces.size()];
+        if(doc.apply_edit(offset, removed, inserted)) {
+            ++local;
+        }
+        expect_fresh(doc);
+        ASSERT_FALSE(HasFatalFailure()) << doc.text();
+
+        /* Undo edits that break the document */
+        if(doc.error_info().is_error()) {
+            doc.apply_edit(offset, inserted.size(), original);
+            ASSERT_FALSE(doc.error_info().is_error()) << doc.text();
+        }
+    }
+    ASSERT_GT(local, 0);
+}
+
@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include "parser_impl.hpp"
+#include <string>
+
+using SimpleJsonParser::BasicParser;
+using SimpleJsonParser::ErrorCode;
+using SimpleJsonParser::NormalParser;
+using SimpleJsonParser::ParseResult;
+using SimpleJsonParser::ParserSettings;
+using SimpleJsonParser::Projection;
+using SimpleJsonParser::StaticPolicy;
+using SimpleJsonParser::make_parser;
+
+TEST(ParserTest, TestParseDocument) {
+    NormalParser parser;
+    ParseResult result = parser.parse("{\"a\": [1, -0.5, \"x\"], \"b\": {\"c\": null}, \"d\": false}");
+    ASSERT_FALSE(result.m_error_info.is_error());
+    ASSERT_EQ(result.m_value["a"].size_array(), 3);
+    ASSERT_EQ(result.m_value["a"][1].fraction(), -0.5);
+    ASSERT_TRUE(result.m_value["b"]["c"].is_null());
+    ASSERT_FALSE(result.m_value["d"].boolean());
+}
+
+TEST(ParserTest, TestReportsSyntaxErrors) {
+    NormalParser parser;
+    ASSERT_EQ(parser.parse("[1, 2").m_error_info.error_code(), ErrorCode::eMissingCommaOrSquareBracket);
+    ASSERT_EQ(parser.parse("{\"a\" 1}").m_error_info.error_code(), ErrorCode::eMissingColon);
+    ASSERT_EQ(parser.parse("\"abc").m_error_info.error_code(), ErrorCode::eMissingDoubleQuote);
+    ASSERT_EQ(parser.parse("1.").m_error_info.error_code(), ErrorCode::eMissingDigitsAfterDot);
+    ASSERT_EQ(parser.parse("[1, 2").m_error_info.offset(), 5);
+}
+
+TEST(ParserTest, TestComments) {
+    std::string json = "// leading\n[1, /* inline */ 2 // trailing\n]";
+
+    NormalParser parser;
+    ParseResult result = parser.parse(json);
+    ASSERT_FALSE(result.m_error_info.is_error());
+    ASSERT_EQ(result.m_value.size_array(), 2);
+
+    ParserSettings settings;
+    settings.allow_comments = false;
+    NormalParser strict(settings);
+    ASSERT_EQ(strict.parse(json).m_error_info.error_code(), ErrorCode::eCommentIsDisallowed);
+
+    BasicParser<StaticPolicy<false, false>> no_comments;
+    ASSERT_EQ(no_comments.parse(json).m_error_info.error_code(), ErrorCode::eCommentIsDisallowed);
+}
+
+TEST(ParserTest, TestLimits) {
+    ParserSettings settings;
+    settings.max_integer_value = 10;
+    settings.min_integer_value = -10;
+    settings.min_fraction_value = -1.0;
+    settings.max_string_length = 3;
+    settings.max_array_length = 2;
+    settings.max_num_members = 1;
+    settings.max_depth_object = 2;
+
+    NormalParser parser(settings);
+    ASSERT_EQ(parser.parse("11").m_error_info.error_code(), ErrorCode::eIntegerIsTooLarge);
+    ASSERT_EQ(parser.parse("-1.5").m_error_info.error_code(), ErrorCode::eFractionIsTooSmall);
+    ASSERT_EQ(parser.parse("\"abcd\"").m_error_info.error_code(), ErrorCode::eStringIsTooLong);
+    ASSERT_EQ(parser.parse("[1, 2, 3]").m_error_info.error_code(), ErrorCode::eArrayIsTooLong);
+    ASSERT_EQ(parser.parse("{\"a\": 1, \"b\": 2}").m_error_info.error_code(), ErrorCode::eObjectHasTooManyMembers);
+    ASSERT_EQ(parser.parse("[[[1]]]").m_error_info.error_code(), ErrorCode::eObjectDepthLimitExceed);
+    ASSERT_FALSE(parser.parse("[[10, \"abc\"]]").m_error_info.is_error());
+
+    /* Literals outside int64_t only fail a narrower bound */
+    ParserSettings defaults;
+    NormalParser unlimited(defaults);
+    ASSERT_FALSE(unlimited.parse("99999999999999999999").m_error_info.is_error());
+    ASSERT_FALSE(unlimited.parse("-99999999999999999999").m_error_info.is_error());
+    ASSERT_EQ(parser.parse("99999999999999999999").m_error_info.error_code(), ErrorCode::eIntegerIsTooLarge);
+    ASSERT_EQ(parser.parse("-99999999999999999999").m_error_info.error_code(), ErrorCode::eIntegerIsTooSmall);
+    ASSERT_FALSE(unlimited.parse("[1e+400, -1e+400]").m_error_info.is_error());
+    ASSERT_EQ(parser.parse("-1e+400").m_error_info.error_code(), ErrorCode::eFractionIsTooSmall);
+}
+
+TEST(ParserTest, TestUncheckedPolicyIgnoresLimits) {
+    ParserSettings settings;
+    settings.max_array_length = 1;
+    BasicParser<StaticPolicy<true, false>> parser(settings);
+    ParseResult result = parser.parse("[1, 2, 3]");
+    ASSERT_FALSE(result.m_error_info.is_error());
+    ASSERT_EQ(result.m_value.size_array(), 3);
+
+    /* The depth still guards the recursion */
+    settings.max_depth_object = 2;
+    BasicParser<StaticPolicy<true, false>> shallow(settings);
+    ASSERT_EQ(shallow.parse("[[[1]]]").m_error_info.error_code(), ErrorCode::eObjectDepthLimitExceed);
+}
+
+TEST(ParserTest, TestMakeParserMatchesNormalParser) {
+    ParserSettings settings;
+    settings.allow_comments = false;
+    settings.max_string_length = 3;
+
+    auto parser = make_parser(settings);
+    NormalParser normal(settings);
+    for(const char* json : {"[\"abc\", 1]", "[\"abcd\"]", "[1, // c\n 2]", "{\"a\": {\"b\": [true]}}"}) {
+        ParseResult expected = normal.parse(json);
+        ParseResult result = parser->parse(json);
+        ASSERT_EQ(result.m_error_info.error_code(), expected.m_error_info.error_code()) << json;
+        ASSERT_EQ(result.m_value, expected.m_value) << json;
+    }
+
+    ParserSettings unlimited;
+    unlimited.max_depth_object = std::numeric_limits<unsigned>::max();
+    auto unchecked = make_parser(unlimited);
+    NormalParser normal_unlimited(unlimited);
+    for(const char* json : {"[99999999999999999999]", "[-99999999999999999999, 1.5e+300]", "[1e+400, -1e+400]"}) {
+        ParseResult expected = normal_unlimited.parse(json);
+        ParseResult result = unchecked->parse(json);
+        ASSERT_FALSE(expected.m_error_info.is_error()) << json;
+        ASSERT_EQ(result.m_error_info.error_code(), expected.m_error_info.error_code()) << json;
+        ASSERT_EQ(result.m_value, expected.m_value) << json;
+    }
+
+    /* The default depth guard alone does not require the checked build */
+    ASSERT_FALSE(unlimited.has_limits());
+    ASSERT_FALSE(ParserSettings{}.has_limits());
+    ASSERT_TRUE(settings.has_limits());
+}
+
+TEST(ParserTest, TestProjectionKeepsSelectedPaths) {
+    ParserSettings settings;
+    settings.projection = Projection::compile({"/a/b", "/c"});
+    NormalParser parser(settings);
+
+    ParseResult result = parser.parse("{\"a\": {\"b\": [1, 2], \"x\": 3}, \"c\": {\"d\": true}, \"e\": \"skipped\"}");
+    ASSERT_FALSE(result.m_error_info.is_error());
+    ASSERT_EQ(result.m_value.size_object(), 2);
+    ASSERT_EQ(result.m_value["a"].size_object(), 1);
+    ASSERT_EQ(result.m_value["a"]["b"].size_array(), 2);
+    ASSERT_TRUE(result.m_value["c"]["d"].boolean());
+
+    /* A scalar where a container was expected is dropped */
+    result = parser.parse("{\"a\": 1}");
+    ASSERT_FALSE(result.m_error_info.is_error());
+    ASSERT_EQ(result.m_value.size_object(), 0);
+}
+
+TEST(ParserTest, TestProjectionWildcard) {
+    ParserSettings settings;
+    settings.projection = Projection::compile({"/items/*/id", "/a~1b", "/m~0n"});
+    NormalParser parser(settings);
+
+    ParseResult result = parser.parse("{\"items\": [{\"id\": 1, \"v\": [0]}, {\"id\": 2}], \"a/b\": 3, \"m~n\": 4}");
+    ASSERT_FALSE(result.m_error_info.is_error());
+    ASSERT_EQ(result.m_value["items"].size_array(), 2);
+    ASSERT_EQ(result.m_value["items"][1].size_object(), 1);
+    ASSERT_EQ(result.m_value["items"][1]["id"].fraction(), 2);
+    ASSERT_EQ(result.m_value["a/b"].fraction(), 3);
+    ASSERT_EQ(result.m_value["m~n"].fraction(), 4);
+
+    ASSERT_THROW(Projection::compile({"items"}), std::invalid_argument);
+}
+
+TEST(ParserTest, TestProjectionUnionOfOverlappingPointers) {
+    ParserSettings settings;
+    settings.projection = Projection::compile({"/*/x", "/a/y"});
+    ParseResult result = NormalParser(settings).parse("{\"a\": {\"x\": 1, \"y\": 2, \"z\": 3}, \"b\": {\"x\": 4, \"y\": 5}}");
+    ASSERT_FALSE(result.m_error_info.is_error());
+    ASSERT_EQ(result.m_value["a"].size_object(), 2);
+    ASSERT_EQ(result.m_value["a"]["x"].fraction(), 1);
+    ASSERT_EQ(result.m_value["a"]["y"].fraction(), 2);
+    ASSERT_EQ(result.m_value["b"].size_object(), 1);
+    ASSERT_EQ(result.m_value["b"]["x"].fraction(), 4);
+
+    settings.projection = Projection::compile({"/items/*/id", "/items/1/name", "/items/*/tags/0", "/items/1/tags/*"});
+    result = NormalParser(settings).parse(
+        "{\"items\": [{\"id\": 0, \"name\": \"a\", \"tags\": [1, 2]}, {\"id\": 1, \"name\": \"b\", \"tags\": [3, 4]}]}");
+    ASSERT_FALSE(result.m_error_info.is_error());
+    ASSERT_EQ(result.m_value["items"][0].size_object(), 2);
+    ASSERT_EQ(result.m_value["items"][0]["tags"].size_array(), 1);
+    ASSERT_EQ(result.m_value["items"][1].size_object(), 3);
+    ASSERT_EQ(result.m_value["items"][1]["name"].string(), "b");
+    ASSERT_EQ(result.m_value["items"][1]["tags"].size_array(), 2);
+
+    /* A whole selected subtree absorbs deeper pointers into it */
+    settings.projection = Projection::compile({"/*", "/a/b"});
+    result = NormalParser(settings).parse("{\"a\": {\"b\": 1, \"c\": 2}, \"d\": 3}");
+    ASSERT_EQ(result.m_value["a"].size_object(), 2);
+    ASSERT_EQ(result.m_value["d"].fraction(), 3);
+
+    /* "01" is a member name, not an array index */
+    settings.projection = Projection::compile({"/01", "/1"});
+    result = NormalParser(settings).parse("[10, 11, 12]");
+    ASSERT_EQ(result.m_value.size_array(), 1);
+    ASSERT_EQ(result.m_value[0].fraction(), 11);
+}
+
+TEST(ParserTest, TestProjectionValidatesSkippedValues) {
+    ParserSettings settings;
+    settings.projection = Projection::compile({"/a"});
+    NormalParser parser(settings);
+
+    ASSERT_EQ(parser.parse("{\"a\": 1, \"b\": [1, 2}").m_error_info.error_code(), ErrorCode::eMissingCommaOrSquareBracket);
+    ASSERT_EQ(parser.parse("{\"a\": 1, \"b\": \"\\q\"}").m_error_info.error_code(), ErrorCode::eMissingControlCharacterAfterBackslash);
+    ASSERT_EQ(parser.parse("{\"a\": 1, \"b\": 1.}").m_error_info.error_code(), ErrorCode::eMissingDigitsAfterDot);
+    ASSERT_FALSE(parser.parse("{\"b\": {\"c\": [\"\\u00e9\", -1e+5, null]}, \"a\": 1}").m_error_info.is_error());
+
+    ParserSettings all;
+    all.projection = Projection::compile({""});
+    ParseResult result = NormalParser(all).parse("{\"a\": 1, \"b\": 2}");
+    ASSERT_EQ(result.m_value.size_object(), 2);
+}
+
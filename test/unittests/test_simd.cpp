@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include "parser_impl.hpp"
+#include "simd.hpp"
+#include <string>
+#include <vector>
+
+using SimpleJsonParser::Kernels;
+using SimpleJsonParser::NormalParser;
+using SimpleJsonParser::ParseResult;
+using SimpleJsonParser::SimdLevel;
+using SimpleJsonParser::detect_simd_level;
+using SimpleJsonParser::kernels_for;
+using SimpleJsonParser::parse_simd_level;
+using SimpleJsonParser::set_simd_level;
+using SimpleJsonParser::simd_level;
+
+namespace {
+    const SimdLevel all_levels[] = {SimdLevel::Scalar, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512};
+
+    std::vector<std::string> make_corpus() {
+        std::vector<std::string> corpus = {
+            "",
+            "   \t\r\n   \t\r\n   \t\r\n   \t\r\n   \t\r\n   \t\r\n   \t\r\n   \t\r\n   \t\r\n x",
+            "{\"key\": [1, 2, {\"nested\": \"value with \\\"escapes\\\" and \\\\ slashes\"}], \"other\": null}",
+            "[\"" + std::string(200, 'a') + "\\n" + std::string(70, 'b') + "\", true, false]",
+            std::string(130, ' ') + "{" + std::string(63, '\n') + "}",
+            "\"caf\xC3\xA9 \xE6\x97\xA5\xE6\x9C\xAC \xF0\x9F\x98\x80\" " + std::string(100, 'z'),
+            std::string(70, 'x') + "\xC0\xAF",
+            std::string(64, 'y') + "\xED\xA0\x80",
+            std::string(33, 'w') + "\xF4\x90\x80\x80",
+            std::string(31, 'v') + "\xE2\x82",
+        };
+        std::string big = "[";
+        for(int i = 0; i < 200; ++i) {
+            big += (i == 0 ? "" : ",\n  ") + std::string("{\"id\": ") + std::to_string(i) + ", \"s\": \"" + std::string(i % 70, 'q') + "\"}";
+        }
+        big += "]";
+        corpus.push_back(big);
+        return corpus;
+    }
+
+    class SimdLevelGuard {
+    public:
+        SimdLevelGuard() : m_level(simd_level()) {}
+        ~SimdLevelGuard() { set_simd_level(m_level); }
+    private:
+        SimdLevel m_level;
+    };
+}
+
+TEST(SimdTest, TestParseSimdLevel) {
+    SimdLevel level;
+    ASSERT_TRUE(parse_simd_level("avx2", level));
+    ASSERT_EQ(level, SimdLevel::AVX2);
+    ASSERT_TRUE(parse_simd_level("scalar", level));
+    ASSERT_EQ(level, SimdLevel::Scalar);
+    ASSERT_FALSE(parse_simd_level("neon", level));
+}
+
+TEST(SimdTest, TestSetSimdLevel) {
+    SimdLevelGuard guard;
+    ASSERT_TRUE(set_simd_level(SimdLevel::Scalar));
+    ASSERT_EQ(simd_level(), SimdLevel::Scalar);
+    ASSERT_TRUE(set_simd_level(detect_simd_level()));
+    ASSERT_EQ(simd_level(), detect_simd_level());
+}
+
+TEST(SimdTest, TestKernelsMatchScalar) {
+    const Kernels& scalar = kernels_for(SimdLevel::Scalar);
+    std::vector<std::string> corpus = make_corpus();
+
+    for(SimdLevel level : all_levels) {
+        if(level > detect_simd_level())
+            continue;
+        const Kernels& k = kernels_for(level);
+        ASSERT_EQ(k.level, level);
+
+        for(const std::string& text : corpus) {
+            for(size_t start = 0; start <= text.size(); ++start) {
+                const char* begin = text.data() + start;
+                const char* end = text.data() + text.size();
+                ASSERT_EQ(k.skip_whitespace(begin, end), scalar.skip_whitespace(begin, end));
+                ASSERT_EQ(k.scan_string(begin, end), scalar.scan_string(begin, end));
+                ASSERT_EQ(k.validate_utf8(begin, end), scalar.validate_utf8(begin, end));
+
+                std::vector<uint32_t> expected(text.size() + 1), actual(text.size() + 1);
+                size_t expected_count = scalar.structural_index(begin, end, expected.data());
+                size_t actual_count = k.structural_index(begin, end, actual.data());
+                ASSERT_EQ(actual_count, expected_count);
+                expected.resize(expected_count);
+                actual.resize(actual_count);
+                ASSERT_EQ(actual, expected);
+            }
+        }
+    }
+}
+
+TEST(SimdTest, TestValidateUtf8) {
+    const Kernels& scalar = kernels_for(SimdLevel::Scalar);
+    auto valid = [&](const std::string& s) { return scalar.validate_utf8(s.data(), s.data() + s.size()); };
+    ASSERT_TRUE(valid("plain ascii"));
+    ASSERT_TRUE(valid("\xC3\xA9\xE6\x97\xA5\xF0\x9F\x98\x80"));
+    ASSERT_FALSE(valid("\xC0\xAF"));
+    ASSERT_FALSE(valid("\xED\xA0\x80"));
+    ASSERT_FALSE(valid("\xF4\x90\x80\x80"));
+    ASSERT_FALSE(valid("\xE2\x82"));
+}
+
+TEST(SimdTest, TestParserMatchesAtEveryLevel) {
+    SimdLevelGuard guard;
+    std::vector<std::string> corpus = make_corpus();
+
+    ASSERT_TRUE(set_simd_level(SimdLevel::Scalar));
+    std::vector<ParseResult> expected;
+    for(const std::string& text : corpus) {
+        NormalParser parser;
+        expected.push_back(parser.parse(text));
+    }
+
+    for(SimdLevel level : all_levels) {
+        if(!set_simd_level(level))
+            continue;
+        for(size_t i = 0; i < corpus.size(); ++i) {
+            NormalParser parser;
+            ParseResult result = parser.parse(corpus[i]);
+            ASSERT_EQ(result.m_error_info.error_code(), expected[i].m_error_info.error_code());
+            ASSERT_EQ(result.m_error_info.offset(), expected[i].m_error_info.offset());
+            ASSERT_EQ(result.m_value, expected[i].m_value);
+        }
+    }
+}
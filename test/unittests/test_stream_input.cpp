@@ -0,0 +1,276 @@
+#include <gtest/gtest.h>
+#include "stream_input.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using SimpleJsonParser::ErrorCode;
+using SimpleJsonParser::FileSource;
+using SimpleJsonParser::NdjsonReader;
+using SimpleJsonParser::NormalParser;
+using SimpleJsonParser::ParseResult;
+using SimpleJsonParser::ParserSettings;
+using SimpleJsonParser::PipelinedArrayReader;
+using SimpleJsonParser::PipelinedInput;
+using SimpleJsonParser::Projection;
+using SimpleJsonParser::Value;
+using SimpleJsonParser::open_input_source;
+using SimpleJsonParser::parse_document;
+
+namespace {
+    std::string write_file(const std::string& name, const std::string& content) {
+        std::string path = ::testing::TempDir() + name;
+        std::ofstream out(path, std::ios::binary);
+        out << content;
+        return path;
+    }
+
+#ifdef SIMPLE_JSON_PARSER_HAS_ZLIB
+    std::string gzip(const std::string& content) {
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+        deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+        std::string out(deflateBound(&stream, content.size()), '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(content.data()));
+        stream.avail_in = static_cast<uInt>(content.size());
+        stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+        stream.avail_out = static_cast<uInt>(out.size());
+        deflate(&stream, Z_FINISH);
+        out.resize(stream.total_out);
+        deflateEnd(&stream);
+        return out;
+    }
+#endif
+
+#ifdef SIMPLE_JSON_PARSER_HAS_ZSTD
+    std::string zstd(const std::string& content) {
+        std::string out(ZSTD_compressBound(content.size()), '\0');
+        out.resize(ZSTD_compress(&out[0], out.size(), content.data(), content.size(), 3));
+        return out;
+    }
+#endif
+
+    std::string make_ndjson(int lines) {
+        std::string text;
+        for(int i = 0; i < lines; ++i) {
+            text += "{\"id\": " + std::to_string(i) + ", \"name\": \"line " + std::to_string(i) + "\"}\n";
+            if(i % 10 == 0)
+                text += "\n";
+        }
+        return text;
+    }
+
+    template<typename Reader>
+    std::vector<Value> read_all(Reader& reader) {
+        std::vector<Value> values;
+        for(Value& value : reader) {
+            values.push_back(std::move(value));
+        }
+        return values;
+    }
+}
+
+TEST(StreamInputTest, TestNdjsonAcrossChunkBoundaries) {
+    std::string path = write_file("plain.ndjson", make_ndjson(100) + "{\"last\": true}");
+
+    PipelinedInput input(std::make_unique<FileSource>(path), 7, 3);
+    NdjsonReader reader(input);
+    std::vector<Value> values = read_all(reader);
+
+    ASSERT_FALSE(reader.error_info().is_error());
+    ASSERT_EQ(values.size(), 101);
+    ASSERT_EQ(values[42]["name"].string(), "line 42");
+    ASSERT_TRUE(values[100]["last"].boolean());
+    std::remove(path.c_str());
+}
+
+TEST(StreamInputTest, TestNdjsonReportsMalformedLine) {
+    std::string path = write_file("broken.ndjson", "{\"a\": 1}\n{\"b\": }\n{\"c\": 3}\n");
+
+    PipelinedInput input(open_input_source(path));
+    NdjsonReader reader(input);
+    std::vector<Value> values = read_all(reader);
+
+    ASSERT_EQ(values.size(), 1);
+    ASSERT_TRUE(reader.error_info().is_error());
+    ASSERT_EQ(reader.error_info().line_number(), 2);
+    std::remove(path.c_str());
+}
+
+TEST(StreamInputTest, TestNdjsonRejectsExtraCharacters) {
+    for(const char* line : {"{\"a\": 1}{\"b\": 2}", "{\"c\": 3} junk", "1 2"}) {
+        std::string path = write_file("extra.ndjson", std::string("{\"ok\": true} \r\n") + line + "\n");
+
+        PipelinedInput input(open_input_source(path));
+        NdjsonReader reader(input);
+        std::vector<Value> values = read_all(reader);
+
+        ASSERT_EQ(values.size(), 1) << line;
+        ASSERT_EQ(reader.error_info().error_code(), ErrorCode::eExtraCharactersAfterValue) << line;
+        ASSERT_EQ(reader.error_info().line_number(), 2) << line;
+        std::remove(path.c_str());
+    }
+}
+
+TEST(StreamInputTest, TestArrayReaderAcrossChunkBoundaries) {
+    std::string json = "/* leading comment */ [";
+    for(int i = 0; i < 200; ++i) {
+        json += i == 0 ? " " : " ,\n";
+        json += "{\"id\": " + std::to_string(i) + ", \"ok\": true, \"v\": [-1.5e+3, null, \"\\u00e9\"]} /* c */";
+    }
+    json += ", \"" + std::string(1000, 'x') + "\", 12345678 ]";
+    std::string path = write_file("array.json", json);
+    std::vector<Value> expected;
+    for(Value& value : NormalParser().parse(json).m_value) {
+        expected.push_back(value.clone());
+    }
+
+    for(size_t chunk_size : {1, 4, 7, 16, 64, 4096}) {
+        PipelinedInput input(open_input_source(path), chunk_size, 3);
+        PipelinedArrayReader reader(input);
+        std::vector<Value> values = read_all(reader);
+
+        ASSERT_FALSE(reader.error_info().is_error()) << chunk_size;
+        ASSERT_EQ(values.size(), expected.size()) << chunk_size;
+        for(size_t i = 0; i < values.size(); ++i) {
+            ASSERT_EQ(values[i], expected[i]) << chunk_size << " " << i;
+        }
+    }
+    std::remove(path.c_str());
+}
+
+TEST(StreamInputTest, TestArrayReaderReportsErrors) {
+    struct Case { const char* json; size_t count; ErrorCode error; size_t offset; };
+    for(const Case& c : {Case{" [ ] ", 0, ErrorCode::NoError, 0},
+                         Case{"[1, 2, {\"a\": }]", 2, ErrorCode::eNoCorrespondingValue, 13},
+                         Case{"[1, 2 3]", 1, ErrorCode::eMissingCommaOrSquareBracket, 6},
+                         Case{"[1, 2", 1, ErrorCode::eMissingCommaOrSquareBracket, 5},
+                         Case{"[\"abc", 0, ErrorCode::eMissingDoubleQuote, 5},
+                         Case{"[tru]", 0, ErrorCode::eNoCorrespondingValue, 1},
+                         Case{"{}", 0, ErrorCode::eNoCorrespondingValue, 0}}) {
+        std::string path = write_file("broken.json", c.json);
+        PipelinedInput input(open_input_source(path), 2, 2);
+        PipelinedArrayReader reader(input);
+        std::vector<Value> values = read_all(reader);
+
+        ASSERT_EQ(values.size(), c.count) << c.json;
+        ASSERT_EQ(reader.error_info().error_code(), c.error) << c.json;
+        ASSERT_EQ(reader.error_info().offset(), c.offset) << c.json;
+        std::remove(path.c_str());
+    }
+}
+
+TEST(StreamInputTest, TestArrayReaderHonorsProjection) {
+    std::string json = "[{\"id\": 1, \"name\": \"a\"}, 2, {\"id\": 3, \"tags\": [1, 2]}, {\"name\": \"d\"}, [4]]";
+    std::string path = write_file("projected.json", json);
+
+    for(const char* pointer : {"/*/id", "/1", "/2/tags", "/x"}) {
+        ParserSettings settings;
+        settings.projection = Projection::compile({pointer});
+        Value expected = NormalParser(settings).parse(json).m_value;
+
+        for(size_t chunk_size : {1, 5, 4096}) {
+            PipelinedInput input(open_input_source(path), chunk_size, 2);
+            PipelinedArrayReader reader(input, settings);
+            std::vector<Value> values = read_all(reader);
+
+            ASSERT_FALSE(reader.error_info().is_error()) << pointer;
+            ASSERT_EQ(values.size(), expected.size_array()) << pointer << " " << chunk_size;
+            for(size_t i = 0; i < values.size(); ++i) {
+                ASSERT_EQ(values[i], expected[i]) << pointer << " " << i;
+            }
+        }
+    }
+    std::remove(path.c_str());
+}
+
+TEST(StreamInputTest, TestArrayReaderDepthLimitCountsTheArray) {
+    std::string path = write_file("deep.json", "[[1], [[1]]]");
+    ParserSettings settings;
+    settings.max_depth_object = 2;
+
+    for(size_t chunk_size : {1, 4096}) {
+        PipelinedInput input(open_input_source(path), chunk_size, 2);
+        PipelinedArrayReader reader(input, settings);
+        std::vector<Value> values = read_all(reader);
+
+        ASSERT_EQ(values.size(), 1) << chunk_size;
+        ASSERT_EQ(reader.error_info().error_code(), ErrorCode::eObjectDepthLimitExceed) << chunk_size;
+    }
+    std::remove(path.c_str());
+}
+
+TEST(StreamInputTest, TestParseDocument) {
+    std::string json = "{\"list\": [1, 2, 3], \"text\": \"" + std::string(100, 'x') + "\"}";
+    std::string path = write_file("document.json", json);
+
+    PipelinedInput input(open_input_source(path), 16, 2);
+    NormalParser parser;
+    ParseResult result = parse_document(input, parser);
+
+    ASSERT_FALSE(result.m_error_info.is_error());
+    ASSERT_EQ(result.m_value, NormalParser().parse(json).m_value);
+    std::remove(path.c_str());
+}
+
+#ifdef SIMPLE_JSON_PARSER_HAS_ZLIB
+TEST(StreamInputTest, TestGzipNdjsonMatchesPlain) {
+    std::string text = make_ndjson(5000);
+    std::string plain_path = write_file("corpus.ndjson", text);
+    std::string gzip_path = write_file("corpus.ndjson.gz", gzip(text.substr(0, 1000)) + gzip(text.substr(1000)));
+
+    PipelinedInput plain_input(open_input_source(plain_path));
+    NdjsonReader plain_reader(plain_input);
+    std::vector<Value> expected = read_all(plain_reader);
+
+    PipelinedInput gzip_input(open_input_source(gzip_path), 4096, 2);
+    NdjsonReader gzip_reader(gzip_input);
+    std::vector<Value> values = read_all(gzip_reader);
+
+    ASSERT_FALSE(gzip_reader.error_info().is_error());
+    ASSERT_EQ(values.size(), 5000);
+    ASSERT_EQ(values.size(), expected.size());
+    for(size_t i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(values[i], expected[i]);
+    }
+    std::remove(plain_path.c_str());
+    std::remove(gzip_path.c_str());
+}
+
+TEST(StreamInputTest, TestCorruptGzipThrows) {
+    std::string compressed = gzip(make_ndjson(1000));
+    std::string path = write_file("truncated.ndjson.gz", compressed.substr(0, compressed.size() / 2));
+
+    PipelinedInput input(open_input_source(path));
+    NdjsonReader reader(input);
+    ASSERT_THROW(read_all(reader), std::runtime_error);
+    std::remove(path.c_str());
+}
+#endif
+
+#ifdef SIMPLE_JSON_PARSER_HAS_ZSTD
+TEST(StreamInputTest, TestZstdNdjsonMatchesPlain) {
+    std::string text = make_ndjson(5000);
+    std::string path = write_file("corpus.ndjson.zst", zstd(text.substr(0, 1000)) + zstd(text.substr(1000)));
+
+    PipelinedInput input(open_input_source(path), 4096, 2);
+    NdjsonReader reader(input);
+    std::vector<Value> values = read_all(reader);
+
+    ASSERT_FALSE(reader.error_info().is_error());
+    ASSERT_EQ(values.size(), 5000);
+    ASSERT_EQ(values[4999]["name"].string(), "line 4999");
+    std::remove(path.c_str());
+}
+
+TEST(StreamInputTest, TestCorruptZstdThrows) {
+    std::string compressed = zstd(make_ndjson(1000));
+    std::string path = write_file("truncated.ndjson.zst", compressed.substr(0, compressed.size() / 2));
+
+    PipelinedInput input(open_input_source(path));
+    NdjsonReader reader(input);
+    ASSERT_THROW(read_all(reader), std::runtime_error);
+    std::remove(path.c_str());
+}
+#endif
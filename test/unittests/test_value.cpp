@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include "document.hpp"
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
 using SimpleJsonParser::Value;
 using SimpleJsonParser::ValueType;
@@ -63,4 +66,238 @@ TEST(ValueObjectTest, TestValueObject) {
     ASSERT_EQ(value["one"].fraction(), 1.0);
     ASSERT_EQ(value["two"].fraction(), 2.0);
     ASSERT_EQ(value["three"].fraction(), 3.0);
-}
\ No newline at end of file
+}
+
+TEST(ValueHashTest, TestEqualValuesHaveEqualHash) {
+    Value a{ValueType::Object};
+    a["name"] = Value{"json"};
+    a["list"] = Value{ValueType::Array};
+    a["list"].push_back(Value{1.0});
+    a["list"].push_back(Value{true});
+
+    Value b = a.clone();
+    ASSERT_EQ(a.hash(), b.hash());
+    ASSERT_TRUE(a.equals(b));
+    ASSERT_EQ(std::hash<Value>{}(a), std::hash<Value>{}(b));
+    ASSERT_EQ(Value{0.0}.hash(), Value{-0.0}.hash());
+}
+
+TEST(ValueHashTest, TestObjectHashIsOrderIndependent) {
+    Value a{ValueType::Object};
+    a.add_member("one", Value{1.0});
+    a.add_member("two", Value{2.0});
+
+    Value b{ValueType::Object};
+    b.add_member("two", Value{2.0});
+    b.add_member("one", Value{1.0});
+
+    ASSERT_EQ(a.hash(), b.hash());
+    ASSERT_TRUE(a.equals(b));
+}
+
+TEST(ValueHashTest, TestArrayHashIsOrderDependent) {
+    Value a{ValueType::Array};
+    a.push_back(Value{1.0});
+    a.push_back(Value{2.0});
+
+    Value b{ValueType::Array};
+    b.push_back(Value{2.0});
+    b.push_back(Value{1.0});
+
+    ASSERT_NE(a.hash(), b.hash());
+    ASSERT_FALSE(a.equals(b));
+}
+
+TEST(ValueHashTest, TestHashCacheIsInvalidatedOnMutation) {
+    Value a{ValueType::Object};
+    a["inner"] = Value{ValueType::Array};
+    a["inner"].push_back(Value{1.0});
+    uint64_t before = a.hash();
+
+    a["inner"].push_back(Value{2.0});
+    ASSERT_NE(a.hash(), before);
+
+    Value b{ValueType::Object};
+    b["inner"] = Value{ValueType::Array};
+    b["inner"].push_back(Value{1.0});
+    b["inner"].push_back(Value{2.0});
+    ASSERT_EQ(a.hash(), b.hash());
+    ASSERT_TRUE(a.equals(b));
+}
+
+TEST(ValueHashTest, TestEqualityIgnoresStaleHash) {
+    Value a{ValueType::Array};
+    a.push_back(Value{ValueType::Array});
+    Value& inner = a[0];
+    a.hash();
+    inner.push_back(Value{1.0});
+
+    Value b{ValueType::Array};
+    b.push_back(Value{ValueType::Array});
+    b[0].push_back(Value{1.0});
+    b.hash();
+    ASSERT_TRUE(a == b);
+}
+
+TEST(ValueHashTest, TestValueAsUnorderedSetKey) {
+    std::unordered_set<Value> set;
+    for(int i = 0; i < 4; ++i) {
+        Value doc{ValueType::Object};
+        doc["id"] = Value{static_cast<int64_t>(i % 2)};
+        set.insert(std::move(doc));
+    }
+    ASSERT_EQ(set.size(), 2);
+}
+
+TEST(ValueMemoryTest, TestMemorySummaryCountsNodes) {
+    Value value{ValueType::Object};
+    value["name"] = Value{std::string(64, 'x')};
+    value["list"] = Value{ValueType::Array};
+    value["list"].push_back(Value{1.0});
+    value["list"].push_back(Value{2.0});
+
+    SimpleJsonParser::MemoryUsage usage = value.memory_summary();
+    ASSERT_EQ(usage.num_nodes, 5);
+    ASSERT_EQ(usage.num_strings, 1);
+    ASSERT_EQ(usage.num_arrays, 1);
+    ASSERT_EQ(usage.num_objects, 1);
+    ASSERT_GE(usage.string_bytes, 65);
+    ASSERT_EQ(value.memory_usage(), usage.total_bytes());
+}
+
+TEST(ValueMemoryTest, TestHashCacheLivesInContainerStorage) {
+    /* Three storage handles, the scalar union and the type tag: no per-node hash cache */
+    ASSERT_LE(sizeof(Value), 3 * sizeof(std::shared_ptr<std::string>) + 2 * sizeof(int64_t));
+
+    Value value{ValueType::Array};
+    value.push_back(Value{1.0});
+    Value copy = value.clone();
+    uint64_t hash = value.hash();
+    ASSERT_EQ(copy.hash(), hash);
+    copy.push_back(Value{2.0});
+    ASSERT_NE(copy.hash(), hash);
+    ASSERT_EQ(value.hash(), hash);
+}
+
+TEST(ValueMemoryTest, TestCompactReleasesSlack) {
+    Value value{ValueType::Array};
+    for(int i = 0; i < 33; ++i) {
+        value.push_back(Value{static_cast<int64_t>(i)});
+    }
+    Value expected = value.clone();
+
+    size_t before = value.memory_usage();
+    ASSERT_GT(value.memory_summary().slack_bytes, 0);
+
+    value.compact();
+    ASSERT_EQ(value.memory_summary().slack_bytes, 0);
+    ASSERT_LT(value.memory_usage(), before);
+    ASSERT_EQ(value, expected);
+}
+
+TEST(ValueCopyOnWriteTest, TestCloneSharesStorage) {
+    Value list{ValueType::Array};
+    list.push_back(Value{1.0});
+    Value value{ValueType::Object};
+    value.add_member("list", std::move(list));
+
+    Value copy = value.clone();
+    ASSERT_TRUE(value.is_shared());
+    ASSERT_TRUE(copy.is_shared());
+    ASSERT_EQ(copy, value);
+
+    Value deep = value.deep_clone();
+    ASSERT_FALSE(deep.is_shared());
+    ASSERT_EQ(deep, value);
+}
+
+TEST(ValueCopyOnWriteTest, TestMutationCopiesOnlyThePath) {
+    Value value{ValueType::Object};
+    value["a"] = Value{ValueType::Object};
+    value["a"]["x"] = Value{1.0};
+    value["b"] = Value{ValueType::Array};
+    value["b"].push_back(Value{"unchanged"});
+
+    Value copy = value.clone();
+    copy["a"]["x"] = Value{2.0};
+
+    ASSERT_EQ(value["a"]["x"].fraction(), 1.0);
+    ASSERT_EQ(copy["a"]["x"].fraction(), 2.0);
+    ASSERT_FALSE(copy.is_shared());
+    ASSERT_FALSE(copy["a"].is_shared());
+
+    const Value& original = value;
+    ASSERT_TRUE(original["b"].is_shared());
+    ASSERT_FALSE(original["a"].is_shared());
+    ASSERT_NE(value.hash(), copy.hash());
+}
+
+TEST(ValueCopyOnWriteTest, TestConstAccessDoesNotCopy) {
+    Value value{ValueType::Array};
+    value.push_back(Value{ValueType::Object});
+    Value copy = value.clone();
+
+    const Value& shared = copy;
+    ASSERT_TRUE(shared[0].is_object());
+    ASSERT_THROW(shared[0]["missing"], std::out_of_range);
+    for(const Value& val : shared) {
+        ASSERT_TRUE(val.is_object());
+    }
+    ASSERT_TRUE(value.is_shared());
+}
+
+TEST(ValueCopyOnWriteTest, TestReferenceTakenBeforeCloneDoesNotReachClone) {
+    Value cfg{ValueType::Object};
+    cfg["server"] = Value{ValueType::Object};
+    cfg["server"]["port"] = Value{static_cast<int64_t>(8080)};
+    Value& port = cfg["server"]["port"];
+    Value snap = cfg.clone();
+    port.set_integer(9090);
+    ASSERT_EQ(snap["server"]["port"].integer(), 8080);
+    ASSERT_EQ(cfg["server"]["port"].integer(), 9090);
+
+    Value arr{ValueType::Array};
+    arr.push_back(Value{static_cast<int64_t>(1)});
+    Value* it = arr.begin();
+    Value copy = arr.clone();
+    it->set_integer(5);
+    ASSERT_EQ(copy[0].integer(), 1);
+    ASSERT_FALSE(copy.is_shared());
+
+    /* A member moved in brings the references into its storage along */
+    Value member{ValueType::Object};
+    member["x"] = Value{static_cast<int64_t>(1)};
+    Value& x = member["x"];
+    Value outer{ValueType::Array};
+    outer.push_back(std::move(member));
+    Value outer_copy = outer.clone();
+    x.set_integer(2);
+    ASSERT_EQ(outer_copy[0]["x"].integer(), 1);
+}
+
+TEST(ValueCopyOnWriteTest, TestConcurrentReadsOfSharedTree) {
+    Value value{ValueType::Array};
+    for(int i = 0; i < 1000; ++i) {
+        Value member{ValueType::Object};
+        member["id"] = Value{static_cast<int64_t>(i)};
+        value.push_back(std::move(member));
+    }
+    const uint64_t expected = value.deep_clone().hash();
+
+    std::vector<std::thread> threads;
+    std::vector<uint64_t> hashes(4);
+    for(size_t i = 0; i < hashes.size(); ++i) {
+        threads.emplace_back([&value, &hashes, i] {
+            Value local = value.clone();
+            const Value& shared = local;
+            hashes[i] = shared.hash();
+        });
+    }
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for(uint64_t hash : hashes) {
+        ASSERT_EQ(hash, expected);
+    }
+}